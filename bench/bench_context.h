@@ -0,0 +1,67 @@
+#ifndef BENCH_CONTEXT_H
+#define BENCH_CONTEXT_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "root_directory.h" // This is a configuration file generated by CMake.
+
+// GL 3.3 core context on a hidden window for the microbenchmarks. the working directory is moved to the
+// project root so the resources/ paths used by the game resolve the same way.
+class BenchContext
+{
+public:
+    GLFWwindow *window = nullptr;
+
+    bool Create()
+    {
+        if (chdir(logl_root) != 0)
+            std::cout << "BENCH:: cannot change into " << logl_root << std::endl;
+        if (!glfwInit())
+            return false;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "BENCH:: failed to create a GL context" << std::endl;
+            return false;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
+        {
+            std::cout << "BENCH:: failed to initialize GLAD" << std::endl;
+            return false;
+        }
+        GLExtensions::Get().Load((GLADloadproc) glfwGetProcAddress);
+        return true;
+    }
+
+    ~BenchContext()
+    {
+        if (window)
+            glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+};
+
+// average wall time of one call of f in microseconds
+template <typename F>
+double microsecondsPerCall(unsigned int iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++)
+        f();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+#endif
@@ -0,0 +1,70 @@
+// culling a growing scene of small objects spread over a large area: the flat per object frustum test against
+// a BVH query, plus what keeping the BVH current costs when objects move (refit) or appear (rebuild).
+// CPU only, no GL context is created.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/bvh.h>
+#include <learnopengl/frustum.h>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main()
+{
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.2f, 2.0f);
+    Bounds bounds = Bounds::FromBox(glm::vec3(-0.5f), glm::vec3(0.5f));
+    Frustum frustum(glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f)
+                    * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    bool matches = true;
+
+    for (unsigned int objects : {1000u, 10000u, 100000u})
+    {
+        std::vector<glm::mat4> transforms(objects);
+        std::vector<AABB> boxes(objects);
+        for (unsigned int i = 0; i < objects; i++)
+        {
+            glm::vec3 at(position(random), position(random) * 0.05f, position(random));
+            transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), at), glm::vec3(size(random)));
+            boxes[i] = AABB::Transformed(bounds, transforms[i]);
+        }
+
+        const unsigned int iterations = std::max(10u, 1000000u / objects);
+        unsigned int flatVisible = 0, treeVisible = 0;
+        double flat = microsecondsPerCall(iterations, [&] {
+            flatVisible = 0;
+            for (const glm::mat4 &transform : transforms)
+                flatVisible += frustum.Visible(bounds, transform);
+        });
+
+        BVH tree;
+        double build = microsecondsPerCall(10, [&] { tree.Build(boxes, 2); });
+        double query = microsecondsPerCall(iterations, [&] {
+            treeVisible = 0;
+            tree.Query(frustum, [&](unsigned int) { treeVisible++; });
+        });
+
+        // one object in a hundred moves a little every frame
+        double refit = microsecondsPerCall(iterations, [&] {
+            for (unsigned int i = 0; i < objects; i += 100)
+            {
+                transforms[i] = glm::translate(transforms[i], glm::vec3(0.01f, 0.0f, 0.0f));
+                tree.Refit(i, AABB::Transformed(bounds, transforms[i]));
+            }
+        });
+
+        // the flat test rejects with the sphere first, the tree only with boxes, so the counts may differ slightly
+        matches = matches && treeVisible >= flatVisible;
+        std::cout << "bvh_bench:: " << objects << " objects, " << treeVisible << " visible: flat test " << flat
+                  << " us, BVH query " << query << " us, refit of 1% " << refit << " us, build " << build << " us" << std::endl;
+    }
+    if (!matches)
+        std::cout << "bvh_bench:: the BVH missed visible objects" << std::endl;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// counts heap allocations made by Model::Draw over many frames of the scene's three models.
+// the first draw of every mesh builds its sampler table, every draw after that has to allocate nothing.
+// also reports how many of the GL state calls of one frame reached GL and how many GLState filtered out.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_m.h>
+#include <learnopengl/model.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static std::atomic<unsigned long> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    Shader shader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
+    Model lazyBag("resources/objects/lazybag/10216_Bean_Bag_Chair_v2_max2008_it2.obj");
+    Model lapTop("resources/objects/laptop/Laptop_High-Polay_HP_BI_2_obj.obj");
+    Model kaktus("resources/objects/kaktus/kwiatek.obj");
+    for (Model *model : {&lazyBag, &lapTop, &kaktus})
+        model->SetShaderTextureNamePrefix("material.");
+    TextureLoader::Get().Finish();
+
+    UniformHandle modelUniform = shader.uniform("model");
+    glm::mat4 model(1.0f);
+    shader.use();
+    auto drawScene = [&] {
+        shader.setMat4(modelUniform, model);
+        lazyBag.Draw(shader);
+        lapTop.Draw(shader);
+        kaktus.Draw(shader);
+    };
+
+    allocations = 0;
+    drawScene(); // builds the sampler tables
+    unsigned long warmup = allocations.exchange(0);
+    const unsigned int frames = 1000;
+    for (unsigned int i = 0; i < frames; i++)
+    {
+        drawScene();
+        GLState::Get().EndFrame();
+    }
+    glFinish();
+    unsigned long perFrame = allocations.load();
+    const GLStateCounters &glCalls = GLState::Get().LastFrame();
+
+    std::cout << "draw_alloc_bench:: " << (lazyBag.meshes.size() + lapTop.meshes.size() + kaktus.meshes.size())
+              << " meshes, " << warmup << " allocations on the first frame, "
+              << perFrame << " allocations over the next " << frames << " frames" << std::endl;
+    std::cout << "draw_alloc_bench:: GL state calls per frame: " << glCalls.issued << " issued, "
+              << glCalls.elided << " elided" << std::endl;
+    return perFrame == 0 ? 0 : 1;
+}
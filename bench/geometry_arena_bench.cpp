@@ -0,0 +1,66 @@
+// the geometry arena under churn: thousands of small meshes allocated, half of them freed at random and the holes
+// refilled with meshes of other sizes, then a defragmentation. prints occupancy after every step and what
+// allocating and compacting cost, each step finished on the GPU.
+
+#include "bench_context.h"
+
+#include <learnopengl/geometry_arena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static void printStats(const char *step)
+{
+    GeometryArenaStats stats = GeometryArena::Get().Stats();
+    std::cout << "geometry_arena_bench:: " << step << ": " << stats.meshes << " meshes in " << stats.pages << " pages, "
+              << stats.usedBytes / 1024 << " of " << stats.capacityBytes / 1024 << " KB used, " << stats.freeBlocks
+              << " free blocks, largest " << stats.largestFreeBytes / 1024 << " KB" << std::endl;
+}
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    std::mt19937 random(17);
+    std::uniform_int_distribution<unsigned int> vertexCount(64, 4096);
+    std::vector<PackedVertex> vertices(4096);
+    std::vector<uint16_t> indices(4096 * 3);
+    std::vector<GeometryRange *> ranges;
+    auto allocate = [&](unsigned int meshes) {
+        for (unsigned int i = 0; i < meshes; i++)
+        {
+            unsigned int count = vertexCount(random);
+            ranges.push_back(GeometryArena::Get().Allocate(vertices.data(), count, indices.data(), count * 3 * sizeof(uint16_t)));
+        }
+        glFinish();
+    };
+
+    double fill = microsecondsPerCall(1, [&] { allocate(4000); });
+    printStats("filled");
+
+    std::shuffle(ranges.begin(), ranges.end(), random);
+    for (size_t i = ranges.size() / 2; i < ranges.size(); i++)
+        GeometryArena::Get().Free(ranges[i]);
+    ranges.resize(ranges.size() / 2);
+    printStats("half freed");
+
+    double refill = microsecondsPerCall(1, [&] { allocate(1000); });
+    printStats("refilled");
+
+    size_t moved = 0;
+    double defragment = microsecondsPerCall(1, [&] {
+        moved = GeometryArena::Get().Defragment();
+        glFinish();
+    });
+    printStats("defragmented");
+
+    std::cout << "geometry_arena_bench:: 4000 allocations " << fill / 1000.0 << " ms, 1000 into holes " << refill / 1000.0
+              << " ms, defragmenting " << moved / 1024 << " KB " << defragment / 1000.0 << " ms" << std::endl;
+    GeometryArena::Get().Delete();
+    return 0;
+}
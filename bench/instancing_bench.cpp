@@ -0,0 +1,83 @@
+// frame cost of drawing many copies of the cactus: one Model::Draw per copy with its own model uniform
+// against a single Model::DrawInstanced over all copies. each frame is finished on the GPU before the next one.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader_m.h>
+#include <learnopengl/model.h>
+#include <learnopengl/uniform_buffer.h>
+
+#include <iostream>
+#include <vector>
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    Shader shader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
+    Shader instancedShader("resources/shaders/2.model_lighting_instanced.vs", "resources/shaders/2.model_lighting.fs");
+    Model kaktus("resources/objects/kaktus/kwiatek.obj");
+    TextureLoader::Get().Finish();
+
+    UniformBuffer frameBuffer, lightBuffer;
+    frameBuffer.Create(sizeof(FrameData), FRAME_DATA_BINDING);
+    lightBuffer.Create(sizeof(LightData), LIGHT_DATA_BINDING);
+    FrameData frame;
+    frame.projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    frame.view = glm::lookAt(glm::vec3(0.0f, 10.0f, 40.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frame.viewPosition = glm::vec4(0.0f, 10.0f, 40.0f, 1.0f);
+    frameBuffer.Update(frame);
+    lightBuffer.Update(LightData());
+    for (Shader *program : {&shader, &instancedShader})
+    {
+        program->bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+        program->bindUniformBlock("LightData", LIGHT_DATA_BINDING);
+    }
+    UniformHandle modelUniform = shader.uniform("model");
+    glEnable(GL_DEPTH_TEST);
+
+    for (unsigned int copies : {1u, 100u, 1000u, 5000u})
+    {
+        // a square grid of small cacti around the origin
+        std::vector<glm::mat4> transforms(copies);
+        unsigned int side = 1;
+        while (side * side < copies)
+            side++;
+        for (unsigned int i = 0; i < copies; i++)
+        {
+            glm::vec3 position((float) (i % side) - side * 0.5f, 0.0f, (float) (i / side) - side * 0.5f);
+            transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), position * 0.5f), glm::vec3(0.005f));
+        }
+
+        const unsigned int frames = 20;
+        double separate = microsecondsPerCall(frames, [&] {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shader.use();
+            for (const glm::mat4 &transform : transforms)
+            {
+                shader.setMat4(modelUniform, transform);
+                kaktus.Draw(shader);
+            }
+            glFinish();
+        });
+        double instanced = microsecondsPerCall(frames, [&] {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            instancedShader.use();
+            kaktus.DrawInstanced(instancedShader, transforms.data(), copies);
+            glFinish();
+        });
+
+        std::cout << "instancing_bench:: " << copies << " copies of " << kaktus.meshes.size() << " meshes: "
+                  << "one draw per copy " << separate / 1000.0 << " ms/frame, instanced "
+                  << instanced / 1000.0 << " ms/frame" << std::endl;
+    }
+
+    frameBuffer.Delete();
+    lightBuffer.Delete();
+    return 0;
+}
@@ -0,0 +1,83 @@
+// the import-time mesh optimizer on spheres delivered as shuffled triangle soup, the worst order an exporter can
+// produce: vertex shader invocations per triangle before and after, and what the pass costs at import.
+// CPU only, no GL context is created.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh_optimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// corner positions of every triangle, rotated to start at the smallest so the set compares whatever the order
+static std::vector<std::vector<float>> triangleSet(const MeshData &data)
+{
+    std::vector<std::vector<float>> triangles;
+    for (size_t t = 0; t < data.indices.size(); t += 3)
+    {
+        std::vector<std::vector<float>> corners;
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            const glm::vec3 &p = data.vertices[data.indices[t + c]].Position;
+            corners.push_back({p.x, p.y, p.z});
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+        triangles.push_back({});
+        for (const std::vector<float> &corner : corners)
+            triangles.back().insert(triangles.back().end(), corner.begin(), corner.end());
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+int main()
+{
+    std::mt19937 random(5);
+    bool matches = true;
+
+    for (unsigned int rings : {16u, 64u, 256u})
+    {
+        auto corner = [rings](unsigned int ring, unsigned int segment) {
+            float theta = 3.14159265f * ring / rings, phi = 6.2831853f * (segment % rings) / rings;
+            Vertex vertex = Vertex();
+            vertex.Position = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.Normal = vertex.Position;
+            return vertex;
+        };
+        std::vector<std::vector<Vertex>> triangles;
+        for (unsigned int ring = 0; ring < rings; ring++)
+            for (unsigned int segment = 0; segment < rings; segment++)
+            {
+                triangles.push_back({corner(ring, segment), corner(ring + 1, segment), corner(ring + 1, segment + 1)});
+                triangles.push_back({corner(ring, segment), corner(ring + 1, segment + 1), corner(ring, segment + 1)});
+            }
+        std::shuffle(triangles.begin(), triangles.end(), random);
+        MeshData soup;
+        for (const std::vector<Vertex> &triangle : triangles)
+            for (const Vertex &vertex : triangle)
+            {
+                soup.indices.push_back((unsigned int) soup.vertices.size());
+                soup.vertices.push_back(vertex);
+            }
+
+        MeshData optimized;
+        double optimize = microsecondsPerCall(5, [&] {
+            optimized = soup;
+            MeshOptimizer::Optimize("sphere", rings, optimized);
+        });
+        matches = matches && triangleSet(optimized) == triangleSet(soup);
+        VertexCacheStats before = MeshOptimizer::Analyze(soup.indices, soup.vertices.size());
+        VertexCacheStats after = MeshOptimizer::Analyze(optimized.indices, optimized.vertices.size());
+        std::cout << "mesh_optimizer_bench:: " << triangles.size() << " triangles, " << soup.vertices.size() << " -> "
+                  << optimized.vertices.size() << " vertices: ACMR " << before.acmr << " -> " << after.acmr << ", ATVR "
+                  << before.atvr << " -> " << after.atvr << ", optimize " << optimize / 1000.0 << " ms" << std::endl;
+    }
+    if (!matches)
+        std::cout << "mesh_optimizer_bench:: the optimizer changed the triangles of a mesh" << std::endl;
+    return matches ? 0 : 1;
+}
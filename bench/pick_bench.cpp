@@ -0,0 +1,94 @@
+// pick latency on a scene of thousands of meshes: copies of the cactus meshes on a grid, rays from random points
+// above it towards random points on it. the SceneTree pick against testing every mesh's box and triangles in turn.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader_m.h>
+#include <learnopengl/model.h>
+#include <learnopengl/scene_tree.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    Model kaktus("resources/objects/kaktus/kwiatek.obj");
+    TextureLoader::Get().Finish();
+
+    // the first pick of a mesh builds its triangle BVH, that cost is paid once per mesh and reported on its own
+    auto start = std::chrono::steady_clock::now();
+    for (Mesh &mesh : kaktus.meshes)
+        mesh.Triangles();
+    double triangleBuild = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "pick_bench:: triangle BVHs of " << kaktus.meshes.size() << " meshes built in " << triangleBuild << " ms" << std::endl;
+
+    std::mt19937 random(5);
+    bool agree = true;
+    for (unsigned int copies : {100u, 1000u, 10000u})
+    {
+        SceneTree tree;
+        unsigned int side = 1;
+        while (side * side < copies)
+            side++;
+        float extent = side * 1.5f;
+        for (unsigned int i = 0; i < copies; i++)
+        {
+            glm::vec3 position((float) (i % side) * 3.0f - extent, 0.0f, (float) (i / side) * 3.0f - extent);
+            glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.01f));
+            for (Mesh &mesh : kaktus.meshes)
+                tree.Add(&mesh, transform, i);
+        }
+
+        std::uniform_real_distribution<float> spread(-extent, extent);
+        std::vector<Ray> rays;
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            glm::vec3 from(spread(random), 5.0f, spread(random));
+            glm::vec3 to(spread(random), 0.0f, spread(random));
+            rays.push_back(Ray(from, to - from));
+        }
+
+        unsigned int next = 0, hits = 0;
+        tree.Pick(rays[0], 100.0f); // builds the tree
+        double picked = microsecondsPerCall(1000, [&] {
+            hits += tree.Pick(rays[next++ % rays.size()], 100.0f).item >= 0;
+        });
+
+        // every mesh in turn: box, then its triangles in model space; distance of the closest hit or -1
+        auto flatPick = [&](const Ray &ray) {
+            float closest = -1.0f;
+            float distance = 100.0f;
+            for (unsigned int item = 0; item < tree.Size(); item++)
+            {
+                const glm::mat4 &transform = tree.Transform(item);
+                if (ray.Enter(AABB::Transformed(tree.MeshOf(item)->bounds, transform), distance) < 0.0f)
+                    continue;
+                if (tree.MeshOf(item)->Triangles().Raycast(ray.Transformed(glm::inverse(transform)), distance) >= 0)
+                    closest = distance;
+            }
+            return closest;
+        };
+        double flat = microsecondsPerCall(100, [&] { flatPick(rays[next++ % rays.size()]); });
+
+        for (const Ray &ray : rays)
+        {
+            PickHit hit = tree.Pick(ray, 100.0f);
+            agree = agree && (hit.item >= 0 ? hit.distance : -1.0f) == flatPick(ray);
+        }
+
+        std::cout << "pick_bench:: " << tree.Size() << " meshes: BVH pick " << picked << " us, every mesh in turn "
+                  << flat << " us (" << hits * 100 / 1000 << "% of rays hit)" << std::endl;
+    }
+    if (!agree)
+        std::cout << "pick_bench:: BVH and flat picks disagree" << std::endl;
+    return agree ? 0 : 1;
+}
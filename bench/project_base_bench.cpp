@@ -0,0 +1,266 @@
+// the game's frame without a window: renders the Scene into an offscreen framebuffer through an EGL surfaceless
+// context (Mesa's llvmpipe works fine), flies scripted camera paths and writes the timings as JSON.
+//
+//   project_base_bench [frames per path] [output.json]
+//
+// without an output file the JSON goes to stdout after the loading report.
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <unistd.h>
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <scene.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const int BENCH_WIDTH = 800;
+const int BENCH_HEIGHT = 600;
+
+// GL 3.3 core context without any surface, rendering goes to a framebuffer object of the game's window size
+class HeadlessContext
+{
+public:
+    bool Create(int width, int height)
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+        {
+            std::cout << "ERROR::BENCH::EGL_INITIALIZE_FAILED" << std::endl;
+            return false;
+        }
+        eglBindAPI(EGL_OPENGL_API);
+
+        const EGLint configAttributes[] = {
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_NONE
+        };
+        EGLConfig config;
+        EGLint configs = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configs) || configs == 0)
+        {
+            std::cout << "ERROR::BENCH::NO_EGL_CONFIG" << std::endl;
+            return false;
+        }
+        const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            std::cout << "ERROR::BENCH::EGL_CONTEXT_FAILED" << std::endl;
+            return false;
+        }
+        if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return false;
+        }
+        GLExtensions::Get().Load((GLADloadproc) eglGetProcAddress);
+
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cout << "ERROR::BENCH::FRAMEBUFFER_INCOMPLETE" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, width, height);
+        return true;
+    }
+
+    ~HeadlessContext()
+    {
+        if (framebuffer)
+        {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(2, renderbuffers);
+        }
+        if (context != EGL_NO_CONTEXT)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY)
+            eglTerminate(display);
+    }
+
+private:
+    EGLDisplay   display = EGL_NO_DISPLAY;
+    EGLContext   context = EGL_NO_CONTEXT;
+    unsigned int framebuffer = 0;
+    unsigned int renderbuffers[2] = {0, 0};
+};
+
+// camera moves linearly from one pose to the other over the frames of the path
+struct CameraPath {
+    const char *name;
+    glm::vec3   from, to;
+    float       yawFrom, yawTo;
+    float       pitch;
+};
+
+const CameraPath CAMERA_PATHS[] = {
+        // where the game starts, nothing moves
+        {"spawn", glm::vec3(-2.32f, 0.54f, 5.87f), glm::vec3(-2.32f, 0.54f, 5.87f), -90.0f, -90.0f, 0.0f},
+        // a full turn from the middle of the room, every object passes through the view
+        {"turn", glm::vec3(3.0f, 0.0f, 10.0f), glm::vec3(3.0f, 0.0f, 10.0f), -90.0f, 270.0f, -10.0f},
+        // across the room towards the laptop
+        {"walk", glm::vec3(-2.32f, 0.54f, 5.87f), glm::vec3(6.0f, 0.0f, 14.0f), -30.0f, 60.0f, -15.0f}
+};
+
+struct Percentiles {
+    double p50, p90, p99, max;
+};
+
+Percentiles percentiles(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) { return samples[(size_t) (p * (samples.size() - 1) + 0.5)]; };
+    return {at(0.50), at(0.90), at(0.99), samples.back()};
+}
+
+std::string json(const Percentiles &value)
+{
+    std::ostringstream out;
+    out << "{\"p50\": " << value.p50 << ", \"p90\": " << value.p90 << ", \"p99\": " << value.p99
+        << ", \"max\": " << value.max << "}";
+    return out.str();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    typedef std::chrono::steady_clock Clock;
+    unsigned int frames = argc > 1 ? (unsigned int) std::max(1, atoi(argv[1])) : 300;
+    // opened before moving into the project root, so a relative path is relative to where the bench was started
+    std::ofstream outputFile;
+    if (argc > 2)
+        outputFile.open(argv[2]);
+    if (chdir(logl_root) != 0)
+        std::cout << "BENCH:: cannot change into " << logl_root << std::endl;
+
+    HeadlessContext context;
+    if (!context.Create(BENCH_WIDTH, BENCH_HEIGHT))
+        return 1;
+    glEnable(GL_DEPTH_TEST);
+
+    // loading: the scene streams in exactly like in the game, frames keep rendering at the spawn point meanwhile
+    Clock::time_point loadingStart = Clock::now();
+    Scene scene;
+    MovingObject objects;
+    Camera spawn(CAMERA_PATHS[0].from, glm::vec3(0.0f, 1.0f, 0.0f), CAMERA_PATHS[0].yawFrom, CAMERA_PATHS[0].pitch);
+    const float aspect = (float) BENCH_WIDTH / (float) BENCH_HEIGHT;
+    double firstFrameMs = -1.0;
+    unsigned int loadingFrames = 0;
+    while (scene.LoadMilliseconds() < 0.0)
+    {
+        Profiler::Get().BeginFrame();
+        scene.Update();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        scene.Render(spawn, objects, false, false, aspect);
+        glFinish();
+        GLState::Get().EndFrame();
+        Profiler::Get().EndFrame();
+        loadingFrames++;
+        if (firstFrameMs < 0.0)
+            firstFrameMs = millisecondsSince(loadingStart);
+        if (millisecondsSince(loadingStart) > 300000.0)
+        {
+            std::cout << "ERROR::BENCH::LOADING_TIMED_OUT" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostringstream out;
+    out << "{\n";
+    out << "  \"renderer\": \"" << (const char *) glGetString(GL_RENDERER) << "\",\n";
+    out << "  \"resolution\": [" << BENCH_WIDTH << ", " << BENCH_HEIGHT << "],\n";
+    out << "  \"frames_per_path\": " << frames << ",\n";
+    out << "  \"load\": {\"first_frame_ms\": " << firstFrameMs << ", \"all_assets_ms\": " << scene.LoadMilliseconds()
+        << ", \"frames_while_loading\": " << loadingFrames << "},\n";
+    out << "  \"paths\": [\n";
+
+    const unsigned int pathCount = sizeof(CAMERA_PATHS) / sizeof(CAMERA_PATHS[0]);
+    for (unsigned int p = 0; p < pathCount; p++)
+    {
+        const CameraPath &path = CAMERA_PATHS[p];
+        std::vector<double> cpuMs, frameMs;
+        double draws = 0.0, issued = 0.0, elided = 0.0, visible = 0.0, culled = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            float t = frames > 1 ? (float) frame / (float) (frames - 1) : 0.0f;
+            Camera camera(glm::mix(path.from, path.to, t), glm::vec3(0.0f, 1.0f, 0.0f),
+                          glm::mix(path.yawFrom, path.yawTo, t), path.pitch);
+
+            // cpu: everything the render loop does before handing the frame over; frame: until the GPU is done
+            Clock::time_point start = Clock::now();
+            Profiler::Get().BeginFrame();
+            scene.Update();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene.Render(camera, objects, false, false, aspect);
+            cpuMs.push_back(millisecondsSince(start));
+            glFinish();
+            frameMs.push_back(millisecondsSince(start));
+            Profiler::Get().EndFrame();
+
+            GLState::Get().EndFrame();
+            draws += scene.DrawCount();
+            issued += GLState::Get().LastFrame().issued;
+            elided += GLState::Get().LastFrame().elided;
+            visible += scene.Culling().visible;
+            culled += scene.Culling().culled;
+        }
+        out << "    {\"name\": \"" << path.name << "\", \"cpu_ms\": " << json(percentiles(cpuMs))
+            << ", \"frame_ms\": " << json(percentiles(frameMs))
+            << ", \"draws_per_frame\": " << draws / frames
+            << ", \"gl_state_calls_per_frame\": {\"issued\": " << issued / frames << ", \"elided\": " << elided / frames << "}"
+            << ", \"culling_per_frame\": {\"visible\": " << visible / frames << ", \"culled\": " << culled / frames << "}"
+            << ", \"zones\": {";
+        // profiler zones, smoothed over the last frames of the path
+        vector<ProfilerZoneStats> zones = Profiler::Get().Zones();
+        for (size_t z = 0; z < zones.size(); z++)
+            out << (z > 0 ? ", " : "") << "\"" << zones[z].name << "\": {\"cpu_ms\": " << zones[z].cpuMilliseconds
+                << ", \"gpu_ms\": " << zones[z].gpuMilliseconds << "}";
+        out << "}}" << (p + 1 < pathCount ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+
+    scene.Delete();
+    if (outputFile.is_open())
+        outputFile << out.str();
+    else
+        std::cout << out.str();
+    return 0;
+}
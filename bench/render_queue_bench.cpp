@@ -0,0 +1,67 @@
+// cost of building and sorting the render queue as the scene grows: random placements of opaque meshes
+// and transparent quads, keyed, radix sorted and checked against the expected order (nothing is drawn).
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader_m.h>
+#include <learnopengl/render_queue.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    Shader lighting("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
+    Shader transparent("resources/shaders/transparentobj.vs", "resources/shaders/transparentobj.fs");
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_int_distribution<unsigned int> name(1, 64);
+    bool sorted = true;
+
+    for (unsigned int objects : {100u, 1000u, 10000u, 100000u})
+    {
+        std::vector<DrawPacket> scene(objects);
+        for (DrawPacket &packet : scene)
+        {
+            bool transparentPacket = random() % 4 == 0;
+            packet.pass = transparentPacket ? PASS_TRANSPARENT : PASS_OPAQUE;
+            packet.shader = transparentPacket ? &transparent : &lighting;
+            packet.vertexArray = name(random);
+            packet.texture = name(random);
+            packet.transform = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+        }
+
+        RenderQueue queue;
+        const unsigned int frames = std::max(10u, 1000000u / objects);
+        double perFrame = microsecondsPerCall(frames, [&] {
+            queue.Begin(glm::vec3(0.0f), 100.0f);
+            for (const DrawPacket &packet : scene)
+                queue.Submit(packet);
+            queue.Sort();
+        });
+        sorted = sorted && std::is_sorted(queue.Keys().begin(), queue.Keys().end());
+
+        std::vector<uint64_t> keys(queue.Keys());
+        std::shuffle(keys.begin(), keys.end(), random);
+        double comparison = microsecondsPerCall(frames, [&] {
+            std::vector<uint64_t> copy(keys);
+            std::sort(copy.begin(), copy.end());
+        });
+
+        std::cout << "render_queue_bench:: " << objects << " draws: submit + radix sort " << perFrame << " us/frame ("
+                  << perFrame * 1000.0 / objects << " ns/draw), std::sort of the keys alone " << comparison << " us" << std::endl;
+    }
+    if (!sorted)
+        std::cout << "render_queue_bench:: keys came out unsorted" << std::endl;
+    return sorted ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+// CPU cost of the per-frame camera and light updates of the render loop: the 33 plain uniforms ourShader used
+// to take, asking GL for every location (how Shader used to work), through the reflected table and through resolved
+// handles, against the FrameData/LightData uniform buffers that replaced them. the plain uniform variant runs on a
+// copy of the lighting shader from before the uniform blocks, kept in bench/shaders.
+
+#include "bench_context.h"
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_m.h>
+#include <learnopengl/uniform_buffer.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the uniforms main() set on ourShader per frame before the uniform buffers, in the same order
+const char *const FRAME_UNIFORMS[] = {
+        "pointLight.position", "pointLight.ambient", "pointLight.diffuse", "pointLight.specular",
+        "pointLight.constant", "pointLight.linear", "pointLight.quadratic", "viewPosition", "material.shininess",
+        "pointLight1.position", "pointLight1.ambient", "pointLight1.diffuse", "pointLight1.specular",
+        "pointLight1.constant", "pointLight1.linear", "pointLight1.quadratic", "viewPosition", "material.shininess",
+        "spotLight.position", "spotLight.direction", "spotLight.ambient", "spotLight.diffuse", "spotLight.specular",
+        "spotLight.constant", "spotLight.linear", "spotLight.quadratic", "spotLight.cutOff", "spotLight.outerCutOff",
+        "projection", "view", "model", "model", "model"
+};
+
+enum UniformKind { KIND_VEC3, KIND_FLOAT, KIND_MAT4 };
+
+UniformKind kindOf(const std::string &name)
+{
+    if (name == "projection" || name == "view" || name == "model")
+        return KIND_MAT4;
+    for (const char *suffix : {"constant", "linear", "quadratic", "shininess", "cutOff", "outerCutOff"})
+        if (name.size() >= strlen(suffix) && name.compare(name.size() - strlen(suffix), std::string::npos, suffix) == 0)
+            return KIND_FLOAT;
+    return KIND_VEC3;
+}
+
+int main()
+{
+    BenchContext context;
+    if (!context.Create())
+        return 1;
+
+    Shader shader("bench/shaders/uniforms_legacy.vs", "bench/shaders/uniforms_legacy.fs");
+    shader.use();
+    Shader blockShader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
+    blockShader.bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+    blockShader.bindUniformBlock("LightData", LIGHT_DATA_BINDING);
+
+    const unsigned int count = sizeof(FRAME_UNIFORMS) / sizeof(FRAME_UNIFORMS[0]);
+    std::vector<UniformKind> kinds;
+    std::vector<UniformHandle> handles;
+    for (const char *name : FRAME_UNIFORMS)
+    {
+        kinds.push_back(kindOf(name));
+        handles.push_back(shader.uniform(name));
+    }
+    glm::vec3 vector(0.5f);
+    glm::mat4 matrix(1.0f);
+    const unsigned int frames = 20000;
+
+    double queried = microsecondsPerCall(frames, [&] {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            int location = glGetUniformLocation(shader.ID, std::string(FRAME_UNIFORMS[i]).c_str());
+            if (kinds[i] == KIND_MAT4)
+                glUniformMatrix4fv(location, 1, GL_FALSE, &matrix[0][0]);
+            else if (kinds[i] == KIND_FLOAT)
+                glUniform1f(location, 0.5f);
+            else
+                glUniform3fv(location, 1, &vector[0]);
+        }
+    });
+    double byName = microsecondsPerCall(frames, [&] {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (kinds[i] == KIND_MAT4)
+                shader.setMat4(FRAME_UNIFORMS[i], matrix);
+            else if (kinds[i] == KIND_FLOAT)
+                shader.setFloat(FRAME_UNIFORMS[i], 0.5f);
+            else
+                shader.setVec3(FRAME_UNIFORMS[i], vector);
+        }
+    });
+    double byHandle = microsecondsPerCall(frames, [&] {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (kinds[i] == KIND_MAT4)
+                shader.setMat4(handles[i], matrix);
+            else if (kinds[i] == KIND_FLOAT)
+                shader.setFloat(handles[i], 0.5f);
+            else
+                shader.setVec3(handles[i], vector);
+        }
+    });
+    UniformBuffer frameBuffer, lightBuffer;
+    frameBuffer.Create(sizeof(FrameData), FRAME_DATA_BINDING);
+    lightBuffer.Create(sizeof(LightData), LIGHT_DATA_BINDING);
+    UniformHandle model = blockShader.uniform("model");
+    FrameData frame;
+    frame.projection = frame.view = matrix;
+    frame.viewPosition = glm::vec4(vector, 1.0f);
+    LightData lights = LightData();
+    blockShader.use();
+    double byBuffer = microsecondsPerCall(frames, [&] {
+        frameBuffer.Update(frame);
+        lightBuffer.Update(lights);
+        for (int i = 0; i < 3; i++)
+            blockShader.setMat4(model, matrix);
+    });
+    glFinish();
+
+    std::cout << "uniform_bench:: " << count << " uniform updates per frame, " << frames << " frames" << std::endl;
+    std::cout << "uniform_bench:: glGetUniformLocation per call: " << queried << " us/frame" << std::endl;
+    std::cout << "uniform_bench:: reflected table by name:       " << byName << " us/frame" << std::endl;
+    std::cout << "uniform_bench:: resolved UniformHandle:         " << byHandle << " us/frame" << std::endl;
+    std::cout << "uniform_bench:: uniform buffers + 3 model:      " << byBuffer << " us/frame" << std::endl;
+    frameBuffer.Delete();
+    lightBuffer.Delete();
+    return 0;
+}
@@ -6,6 +6,8 @@
 #define PROJECT_BASE_COMMON_H
 #include <string>
 #include <fstream>
+#include <iostream>
+#include <set>
 #include <sstream>
 
 std::string readFileContents(std::string path) {
@@ -15,6 +17,58 @@ std::string readFileContents(std::string path) {
     return buffer.str();
 }
 
+// appends a shader file to out with every #include "file" line replaced by that file, looked up next to the
+// including one. a file is only spliced in once, so shared headers need no guards. #line keeps the line numbers
+// of compile errors matching the file they happened in
+void appendShaderSource(const std::string &path, std::string &out, std::set<std::string> &included) {
+    if (!included.insert(path).second)
+        return;
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return;
+    }
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    std::string line;
+    unsigned int number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start);
+            size_t close = line.find('"', open + 1);
+            if (open == std::string::npos || close == std::string::npos) {
+                std::cout << "ERROR::SHADER::BAD_INCLUDE " << path << ":" << number << std::endl;
+                continue;
+            }
+            out += "#line 1\n";
+            appendShaderSource(directory + line.substr(open + 1, close - open - 1), out, included);
+            out += "#line " + std::to_string(number + 1) + "\n";
+            continue;
+        }
+        out += line;
+        out += '\n';
+    }
+}
+
+// the source of a shader file as the compiler gets it: includes resolved and the defines, "#define NAME value"
+// lines, placed right after the #version line, which has to stay first. files gets every file read
+std::string readShaderSource(const std::string &path, const std::string &defines = "", std::set<std::string> *files = nullptr) {
+    std::string source;
+    std::set<std::string> included;
+    appendShaderSource(path, source, included);
+    if (files)
+        files->insert(included.begin(), included.end());
+    if (!defines.empty()) {
+        size_t version = source.compare(0, 8, "#version") == 0 ? source.find('\n') : std::string::npos;
+        if (version == std::string::npos)
+            source = defines + "#line 1\n" + source;
+        else
+            source.insert(version + 1, defines + "#line 2\n");
+    }
+    return source;
+}
+
 void appendShaderFolderIfNotPresent(std::string& path) {
     std::ifstream file(path);
     if (!file) {
@@ -0,0 +1,293 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/frustum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+// axis aligned box in whatever space its user works in
+struct AABB {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+    glm::vec3 Extent() const { return (max - min) * 0.5f; }
+
+    void Grow(const AABB &other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    // the world space box around model space bounds under a model matrix
+    static AABB Transformed(const Bounds &bounds, const glm::mat4 &transform)
+    {
+        glm::vec3 half = (bounds.max - bounds.min) * 0.5f;
+        glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+        glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * half.x + glm::abs(glm::vec3(transform[1])) * half.y
+                           + glm::abs(glm::vec3(transform[2])) * half.z;
+        AABB box;
+        box.min = center - extent;
+        box.max = center + extent;
+        return box;
+    }
+};
+
+// origin + t * direction for t >= 0; the direction does not need to be normalized, hit distances are in units of it
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    glm::vec3 inverseDirection;
+
+    Ray(const glm::vec3 &origin, const glm::vec3 &direction)
+        : origin(origin), direction(direction), inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z) {}
+
+    // the same ray in the space a transform maps into world space; t stays the same along both
+    Ray Transformed(const glm::mat4 &inverseTransform) const
+    {
+        return Ray(glm::vec3(inverseTransform * glm::vec4(origin, 1.0f)), glm::vec3(inverseTransform * glm::vec4(direction, 0.0f)));
+    }
+
+    // slab test, distance to where the ray enters the box or a negative value when it misses it before maxDistance
+    float Enter(const AABB &box, float maxDistance) const
+    {
+        glm::vec3 t0 = (box.min - origin) * inverseDirection;
+        glm::vec3 t1 = (box.max - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        return enter <= exit ? enter : -1.0f;
+    }
+
+    // Moeller-Trumbore, both faces; distance of the hit or a negative value
+    float Intersect(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) const
+    {
+        const float EPSILON = 1e-8f;
+        glm::vec3 edge1 = b - a, edge2 = c - a;
+        glm::vec3 p = glm::cross(direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::fabs(determinant) < EPSILON)
+            return -1.0f;
+        float inverse = 1.0f / determinant;
+        glm::vec3 s = origin - a;
+        float u = glm::dot(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f)
+            return -1.0f;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f)
+            return -1.0f;
+        return glm::dot(edge2, q) * inverse;
+    }
+};
+
+// bounding volume hierarchy over a set of boxes, the items are identified by their index in the build input.
+// built top down with a median split along the widest axis of the item centers; when items move Refit()
+// grows and shrinks the boxes on their path to the root without changing the tree, which stays fine as long
+// as the items move little compared to the whole scene, otherwise Build() again.
+class BVH
+{
+public:
+    void Build(const vector<AABB> &boxes, unsigned int leafSize)
+    {
+        this->boxes = boxes;
+        this->leafSize = std::max(1u, leafSize);
+        nodes.clear();
+        parents.clear();
+        items.resize(boxes.size());
+        leafOf.resize(boxes.size());
+        for (unsigned int i = 0; i < items.size(); i++)
+            items[i] = i;
+        if (boxes.empty())
+            return;
+        nodes.reserve(2 * boxes.size() / this->leafSize + 1);
+        nodes.push_back(Node());
+        parents.push_back((unsigned int) NONE);
+        build(0, 0, (unsigned int) items.size());
+    }
+
+    // the item now covers box, every node above it is updated
+    void Refit(unsigned int item, const AABB &box)
+    {
+        boxes[item] = box;
+        unsigned int node = leafOf[item];
+        Node &leaf = nodes[node];
+        leaf.box = boxes[items[leaf.first]];
+        for (unsigned int i = leaf.first + 1; i < leaf.first + leaf.count; i++)
+            leaf.box.Grow(boxes[items[i]]);
+        for (node = parents[node]; node != NONE; node = parents[node])
+        {
+            nodes[node].box = nodes[nodes[node].first].box;
+            nodes[node].box.Grow(nodes[nodes[node].first + 1].box);
+        }
+    }
+
+    // calls visit(item) for every item whose box is at least partly inside the frustum
+    template <typename F>
+    void Query(const Frustum &frustum, F visit) const
+    {
+        unsigned int stack[STACK_SIZE];
+        unsigned int size = 0;
+        if (!nodes.empty())
+            stack[size++] = 0;
+        while (size > 0)
+        {
+            const Node &node = nodes[stack[--size]];
+            if (!frustum.BoxVisible(node.box.Center(), node.box.Extent()))
+                continue;
+            if (node.count == 0)
+            {
+                stack[size++] = node.first;
+                stack[size++] = node.first + 1;
+                continue;
+            }
+            for (unsigned int i = node.first; i < node.first + node.count; i++)
+                if (node.count == 1 || frustum.BoxVisible(boxes[items[i]].Center(), boxes[items[i]].Extent()))
+                    visit(items[i]);
+        }
+    }
+
+    // closest hit along the ray: hit(item, ray, distance) tests one item precisely and returns true after lowering
+    // distance to a closer hit. children are visited near to far, so boxes behind the closest hit so far are skipped.
+    // returns the item hit first, or -1 with distance untouched.
+    template <typename F>
+    int Raycast(const Ray &ray, float &distance, F hit) const
+    {
+        int closest = -1;
+        unsigned int stack[STACK_SIZE];
+        unsigned int size = 0;
+        if (!nodes.empty() && ray.Enter(nodes[0].box, distance) >= 0.0f)
+            stack[size++] = 0;
+        while (size > 0)
+        {
+            const Node &node = nodes[stack[--size]];
+            if (ray.Enter(node.box, distance) < 0.0f)
+                continue;
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.first; i < node.first + node.count; i++)
+                    if (ray.Enter(boxes[items[i]], distance) >= 0.0f && hit(items[i], ray, distance))
+                        closest = (int) items[i];
+                continue;
+            }
+            float enterLeft = ray.Enter(nodes[node.first].box, distance);
+            float enterRight = ray.Enter(nodes[node.first + 1].box, distance);
+            unsigned int nearChild = node.first, farChild = node.first + 1;
+            if (enterRight >= 0.0f && (enterLeft < 0.0f || enterRight < enterLeft))
+            {
+                std::swap(nearChild, farChild);
+                std::swap(enterLeft, enterRight);
+            }
+            // the near child goes on top so it is visited first
+            if (enterRight >= 0.0f)
+                stack[size++] = farChild;
+            if (enterLeft >= 0.0f)
+                stack[size++] = nearChild;
+        }
+        return closest;
+    }
+
+    unsigned int Size() const { return (unsigned int) boxes.size(); }
+    const AABB &Box(unsigned int item) const { return boxes[item]; }
+
+private:
+    static const unsigned int NONE = ~0u;
+    // the median split keeps the depth at log2 of the item count, two entries per level
+    static const unsigned int STACK_SIZE = 64;
+
+    // interior nodes have count 0 and their children at first and first + 1, leaves own items[first, first + count)
+    struct Node {
+        AABB         box;
+        unsigned int first = 0;
+        unsigned int count = 0;
+    };
+
+    vector<Node>         nodes;
+    vector<unsigned int> parents;
+    vector<AABB>         boxes;
+    vector<unsigned int> items;
+    vector<unsigned int> leafOf;
+    unsigned int         leafSize = 1;
+
+    void build(unsigned int node, unsigned int begin, unsigned int end)
+    {
+        AABB box = boxes[items[begin]];
+        AABB centers;
+        centers.min = centers.max = box.Center();
+        for (unsigned int i = begin + 1; i < end; i++)
+        {
+            box.Grow(boxes[items[i]]);
+            glm::vec3 center = boxes[items[i]].Center();
+            centers.min = glm::min(centers.min, center);
+            centers.max = glm::max(centers.max, center);
+        }
+        nodes[node].box = box;
+
+        glm::vec3 spread = centers.max - centers.min;
+        int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+        if (end - begin <= leafSize || spread[axis] <= 0.0f)
+        {
+            nodes[node].first = begin;
+            nodes[node].count = end - begin;
+            for (unsigned int i = begin; i < end; i++)
+                leafOf[items[i]] = node;
+            return;
+        }
+
+        unsigned int middle = begin + (end - begin) / 2;
+        std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                         [&](unsigned int a, unsigned int b) { return boxes[a].Center()[axis] < boxes[b].Center()[axis]; });
+        unsigned int left = (unsigned int) nodes.size();
+        nodes.resize(left + 2);
+        parents.push_back(node);
+        parents.push_back(node);
+        nodes[node].first = left;
+        nodes[node].count = 0;
+        build(left, begin, middle);
+        build(left + 1, middle, end);
+    }
+};
+
+// BVH over the triangles of an indexed mesh, for ray casts in the mesh's model space
+class TriangleBVH
+{
+public:
+    void Build(const vector<glm::vec3> &positions, const vector<unsigned int> &indices)
+    {
+        corners.resize(indices.size());
+        vector<AABB> boxes(indices.size() / 3);
+        for (size_t triangle = 0; triangle < boxes.size(); triangle++)
+        {
+            for (unsigned int corner = 0; corner < 3; corner++)
+                corners[triangle * 3 + corner] = positions[indices[triangle * 3 + corner]];
+            boxes[triangle].min = glm::min(corners[triangle * 3], glm::min(corners[triangle * 3 + 1], corners[triangle * 3 + 2]));
+            boxes[triangle].max = glm::max(corners[triangle * 3], glm::max(corners[triangle * 3 + 1], corners[triangle * 3 + 2]));
+        }
+        tree.Build(boxes, 4);
+    }
+
+    // index of the closest triangle hit before distance, distance is lowered to the hit; -1 on a miss
+    int Raycast(const Ray &ray, float &distance) const
+    {
+        return tree.Raycast(ray, distance, [&](unsigned int triangle, const Ray &, float &closest) {
+            float t = ray.Intersect(corners[triangle * 3], corners[triangle * 3 + 1], corners[triangle * 3 + 2]);
+            if (t < 0.0f || t >= closest)
+                return false;
+            closest = t;
+            return true;
+        });
+    }
+
+    bool Empty() const { return tree.Size() == 0; }
+
+private:
+    BVH               tree;
+    vector<glm::vec3> corners;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <learnopengl/trace.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// reports files written in a set of directories, watched with inotify on a background thread.
+// editors either rewrite a file in place or write a new one and rename it over the old, both are caught.
+// paths come back as directory + "/" + file name, with the directory exactly as passed to Watch().
+// without inotify (not Linux) Watch() fails and nothing is ever reported.
+class FileWatcher
+{
+public:
+    FileWatcher() {}
+    ~FileWatcher() { Stop(); }
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // starts watching; call once
+    bool Watch(const vector<string> &directories)
+    {
+#ifdef __linux__
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stopFd = eventfd(0, EFD_CLOEXEC);
+        if (inotifyFd < 0 || stopFd < 0)
+        {
+            cout << "ERROR::FILE_WATCHER:: inotify unavailable" << endl;
+            Stop();
+            return false;
+        }
+        for (const string &directory : directories)
+        {
+            int watch = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch < 0)
+                cout << "ERROR::FILE_WATCHER:: cannot watch " << directory << endl;
+            else
+                watched[watch] = directory;
+        }
+        worker = thread(&FileWatcher::run, this);
+        return true;
+#else
+        (void) directories;
+        return false;
+#endif
+    }
+
+    // files written since the last call, each once however often it was written
+    vector<string> TakeChanges()
+    {
+        lock_guard<mutex> lock(changesMutex);
+        vector<string> taken(changes.begin(), changes.end());
+        changes.clear();
+        return taken;
+    }
+
+    void Stop()
+    {
+#ifdef __linux__
+        if (worker.joinable())
+        {
+            uint64_t one = 1;
+            if (write(stopFd, &one, sizeof(one)) != sizeof(one))
+                cout << "ERROR::FILE_WATCHER:: cannot stop the watcher thread" << endl;
+            worker.join();
+        }
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+        if (stopFd >= 0)
+            close(stopFd);
+        inotifyFd = stopFd = -1;
+#endif
+    }
+
+private:
+    int                inotifyFd = -1;
+    int                stopFd = -1;
+    thread             worker;
+    // written before the thread starts, only read after
+    map<int, string>   watched;
+    mutex              changesMutex;
+    set<string>        changes;
+
+#ifdef __linux__
+    void run()
+    {
+        Trace::Get().SetThreadName("file watcher");
+        // events are aligned like this struct, the buffer holds a burst of them
+        alignas(inotify_event) char buffer[4096];
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        for (;;)
+        {
+            if (poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (fds[1].revents & POLLIN)
+                break;
+            ssize_t length;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+            {
+                lock_guard<mutex> lock(changesMutex);
+                for (char *next = buffer; next < buffer + length; )
+                {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(next);
+                    auto directory = watched.find(event->wd);
+                    if (event->len > 0 && directory != watched.end())
+                        changes.insert(directory->second + "/" + event->name);
+                    next += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+// model space bounds of a piece of geometry: the box and the sphere around the box center enclosing it
+struct Bounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float     radius = 0.0f;
+
+    static Bounds FromBox(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        Bounds bounds;
+        bounds.min = min;
+        bounds.max = max;
+        bounds.center = (min + max) * 0.5f;
+        bounds.radius = glm::length(max - bounds.center);
+        return bounds;
+    }
+
+    // count positions starting at data, stride is in floats
+    static Bounds FromPositions(const float *data, unsigned int count, unsigned int stride)
+    {
+        if (count == 0)
+            return Bounds();
+        glm::vec3 min(data[0], data[1], data[2]), max = min;
+        for (unsigned int i = 1; i < count; i++)
+        {
+            glm::vec3 position(data[i * stride], data[i * stride + 1], data[i * stride + 2]);
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        return FromBox(min, max);
+    }
+};
+
+// number of bounds that passed and failed the frustum test during one frame
+struct CullingCounters {
+    unsigned int visible = 0;
+    unsigned int culled = 0;
+};
+
+// the six clip planes of a camera in world space, extracted from projection * view (Gribb/Hartmann).
+// planes are stored as separate x, y, z, w arrays padded to eight so the per plane loops vectorize;
+// the two padding planes accept everything.
+class Frustum
+{
+public:
+    Frustum() { Set(glm::mat4(1.0f)); }
+
+    explicit Frustum(const glm::mat4 &viewProjection) { Set(viewProjection); }
+
+    void Set(const glm::mat4 &m)
+    {
+        // glm is column major, m[column][row]
+        for (int plane = 0; plane < 6; plane++)
+        {
+            int row = plane / 2;
+            float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+            glm::vec4 p(m[0][3] + sign * m[0][row], m[1][3] + sign * m[1][row],
+                        m[2][3] + sign * m[2][row], m[3][3] + sign * m[3][row]);
+            float length = glm::length(glm::vec3(p));
+            x[plane] = p.x / length;
+            y[plane] = p.y / length;
+            z[plane] = p.z / length;
+            w[plane] = p.w / length;
+        }
+        for (int plane = 6; plane < 8; plane++)
+        {
+            x[plane] = y[plane] = z[plane] = 0.0f;
+            w[plane] = 1.0f;
+        }
+    }
+
+    // world space sphere against all planes at once
+    bool SphereVisible(const glm::vec3 &center, float radius) const
+    {
+        bool outside = false;
+        for (int plane = 0; plane < 8; plane++)
+            outside |= x[plane] * center.x + y[plane] * center.y + z[plane] * center.z + w[plane] < -radius;
+        return !outside;
+    }
+
+    // world space box given by center and half extents, tested with the extent projected on each plane normal
+    bool BoxVisible(const glm::vec3 &center, const glm::vec3 &extent) const
+    {
+        bool outside = false;
+        for (int plane = 0; plane < 8; plane++)
+        {
+            float distance = x[plane] * center.x + y[plane] * center.y + z[plane] * center.z + w[plane];
+            float reach = std::fabs(x[plane]) * extent.x + std::fabs(y[plane]) * extent.y + std::fabs(z[plane]) * extent.z;
+            outside |= distance < -reach;
+        }
+        return !outside;
+    }
+
+    // model space bounds under a model matrix: the cheap sphere test rejects first, the box decides the rest.
+    // the box is the world space box around the transformed one, so it is conservative but never wrong.
+    bool Visible(const Bounds &bounds, const glm::mat4 &transform) const
+    {
+        glm::vec3 center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+        glm::vec3 axisX = glm::vec3(transform[0]), axisY = glm::vec3(transform[1]), axisZ = glm::vec3(transform[2]);
+        float scale = std::sqrt(glm::max(glm::dot(axisX, axisX), glm::max(glm::dot(axisY, axisY), glm::dot(axisZ, axisZ))));
+        if (!SphereVisible(center, bounds.radius * scale))
+            return false;
+
+        glm::vec3 half = (bounds.max - bounds.min) * 0.5f;
+        glm::vec3 extent = glm::abs(axisX) * half.x + glm::abs(axisY) * half.y + glm::abs(axisZ) * half.z;
+        return BoxVisible(center, extent);
+    }
+
+private:
+    float x[8], y[8], z[8], w[8];
+};
+
+#endif
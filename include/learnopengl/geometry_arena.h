@@ -0,0 +1,328 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_state.h>
+#include <learnopengl/vertex_format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+using namespace std;
+
+// capacity of a page; a mesh that does not fit gets a page of its own size
+#define GEOMETRY_PAGE_VERTICES (1 << 18)
+#define GEOMETRY_PAGE_INDEX_BYTES (4 << 20)
+
+// where a mesh lives in the arena. the arena owns it and updates it when Defragment() moves the mesh
+struct GeometryRange {
+    unsigned int page;
+    // the page's, shared by every mesh in it
+    unsigned int vertexArray;
+    // in vertices from the start of the page's vertex buffer, what glDrawElementsBaseVertex adds to every index
+    GLint        baseVertex;
+    unsigned int vertexCount;
+    // in bytes into the page's index buffer; indexBytes is rounded up to 4 so ranges sit back to back
+    size_t       indexOffset;
+    size_t       indexBytes;
+};
+
+struct GeometryArenaStats {
+    unsigned int pages = 0, meshes = 0;
+    size_t capacityBytes = 0, usedBytes = 0;
+    // free space of all pages, the number of holes it is split into and the largest of them
+    size_t freeBytes = 0, freeBlocks = 0, largestFreeBytes = 0;
+};
+
+// first fit allocator over [0, capacity); free blocks are kept by offset so a released block merges with its
+// free neighbours
+class FreeList
+{
+public:
+    void Reset(size_t capacity, size_t used = 0)
+    {
+        free.clear();
+        if (used < capacity)
+            free[used] = capacity - used;
+        this->capacity = capacity;
+        this->used = used;
+    }
+
+    bool Allocate(size_t size, size_t alignment, size_t &offset)
+    {
+        for (auto block = free.begin(); block != free.end(); ++block)
+        {
+            size_t blockStart = block->first, blockEnd = block->first + block->second;
+            size_t start = (blockStart + alignment - 1) / alignment * alignment;
+            if (start + size > blockEnd)
+                continue;
+            free.erase(block);
+            // the alignment padding stays free
+            if (start > blockStart)
+                free[blockStart] = start - blockStart;
+            if (start + size < blockEnd)
+                free[start + size] = blockEnd - start - size;
+            offset = start;
+            used += size;
+            return true;
+        }
+        return false;
+    }
+
+    void Release(size_t offset, size_t size)
+    {
+        used -= size;
+        auto next = free.lower_bound(offset);
+        if (next != free.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = free.erase(next);
+        }
+        if (next != free.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                previous->second += size;
+                return;
+            }
+        }
+        free[offset] = size;
+    }
+
+    size_t Capacity() const { return capacity; }
+    size_t Used() const { return used; }
+    size_t Blocks() const { return free.size(); }
+
+    size_t Largest() const
+    {
+        size_t largest = 0;
+        for (const auto &block : free)
+            largest = max(largest, block.second);
+        return largest;
+    }
+
+private:
+    map<size_t, size_t> free;
+    size_t capacity = 0, used = 0;
+};
+
+// every mesh's vertices and indices in a few large buffer pages instead of a VAO, VBO and EBO per mesh. each page
+// has one VAO in the PackedVertex layout; meshes draw from it with glDrawElementsBaseVertex, so draws of meshes on
+// the same page never switch vertex arrays. GL thread only.
+class GeometryArena
+{
+public:
+    static GeometryArena &Get()
+    {
+        static GeometryArena arena;
+        return arena;
+    }
+
+    // copies a mesh into the first page with room for both its vertices and its indices, or into a new page
+    GeometryRange *Allocate(const PackedVertex *vertices, unsigned int vertexCount, const void *indices, size_t indexBytes)
+    {
+        // 4 keeps 32-bit indices aligned; 16-bit meshes with an odd index count take the 2 bytes after them
+        size_t reservedBytes = (indexBytes + 3) / 4 * 4;
+        for (unsigned int p = 0; p < pages.size(); p++)
+        {
+            GeometryRange *range = allocateIn(p, vertexCount, reservedBytes);
+            if (range)
+                return upload(range, vertices, indices, indexBytes);
+        }
+        pages.push_back(unique_ptr<Page>(new Page()));
+        createPage(*pages.back(), max((size_t) GEOMETRY_PAGE_VERTICES, (size_t) vertexCount),
+                   max((size_t) GEOMETRY_PAGE_INDEX_BYTES, reservedBytes));
+        return upload(allocateIn((unsigned int) pages.size() - 1, vertexCount, reservedBytes), vertices, indices, indexBytes);
+    }
+
+    // gives the space of a mesh back to its page, the range is gone afterwards
+    void Free(GeometryRange *range)
+    {
+        Page &page = *pages[range->page];
+        page.vertices.Release(range->baseVertex, range->vertexCount);
+        page.indices.Release(range->indexOffset, range->indexBytes);
+        for (auto owned = page.ranges.begin(); owned != page.ranges.end(); ++owned)
+            if (owned->get() == range)
+            {
+                page.ranges.erase(owned);
+                break;
+            }
+    }
+
+    // points the instance attributes of a page's VAO at a buffer of mat4, one per instance; nothing to do when
+    // the last instanced draw from the page used the same buffer
+    void BindInstanceBuffer(const GeometryRange *range, unsigned int buffer)
+    {
+        Page &page = *pages[range->page];
+        if (page.instanceBuffer == buffer)
+            return;
+        page.instanceBuffer = buffer;
+        GLState::Get().BindVertexArray(page.vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        SetupInstanceAttributes();
+    }
+
+    // compacts every page whose free space is split into more than one hole, moving its meshes to the front of
+    // new buffers on the GPU; returns the bytes moved. draws issued afterwards read the updated ranges
+    size_t Defragment()
+    {
+        size_t moved = 0;
+        for (unique_ptr<Page> &page : pages)
+            if (page->vertices.Blocks() > 1 || page->indices.Blocks() > 1)
+                moved += compact(*page);
+        return moved;
+    }
+
+    GeometryArenaStats Stats() const
+    {
+        GeometryArenaStats stats;
+        stats.pages = (unsigned int) pages.size();
+        for (const unique_ptr<Page> &page : pages)
+        {
+            stats.meshes += (unsigned int) page->ranges.size();
+            stats.capacityBytes += page->vertices.Capacity() * sizeof(PackedVertex) + page->indices.Capacity();
+            stats.usedBytes += page->vertices.Used() * sizeof(PackedVertex) + page->indices.Used();
+            stats.freeBlocks += page->vertices.Blocks() + page->indices.Blocks();
+            stats.largestFreeBytes = max(stats.largestFreeBytes, max(page->vertices.Largest() * sizeof(PackedVertex), page->indices.Largest()));
+        }
+        stats.freeBytes = stats.capacityBytes - stats.usedBytes;
+        return stats;
+    }
+
+    void PrintReport() const
+    {
+        GeometryArenaStats stats = Stats();
+        cout << "GEOMETRY_ARENA:: " << stats.meshes << " meshes in " << stats.pages << " pages, " << stats.usedBytes / 1024
+             << " of " << stats.capacityBytes / 1024 << " KB used, " << stats.freeBlocks << " free blocks, largest "
+             << stats.largestFreeBytes / 1024 << " KB" << endl;
+    }
+
+    // deletes every page; all ranges become invalid
+    void Delete()
+    {
+        for (unique_ptr<Page> &page : pages)
+        {
+            GLState::Get().ForgetVertexArray(page->vertexArray);
+            glDeleteVertexArrays(1, &page->vertexArray);
+            unsigned int buffers[] = {page->vertexBuffer, page->indexBuffer};
+            glDeleteBuffers(2, buffers);
+        }
+        pages.clear();
+    }
+
+private:
+    struct Page {
+        unsigned int vertexArray = 0, vertexBuffer = 0, indexBuffer = 0;
+        // the buffer the instance attributes of vertexArray point at, see BindInstanceBuffer
+        unsigned int instanceBuffer = 0;
+        // in vertices and in bytes
+        FreeList     vertices, indices;
+        vector<unique_ptr<GeometryRange>> ranges;
+    };
+
+    vector<unique_ptr<Page>> pages;
+
+    GeometryRange *allocateIn(unsigned int p, unsigned int vertexCount, size_t indexBytes)
+    {
+        Page &page = *pages[p];
+        size_t vertexOffset, indexOffset;
+        if (!page.vertices.Allocate(vertexCount, 1, vertexOffset))
+            return nullptr;
+        // every index range is a multiple of 4 bytes, so every free block starts aligned
+        if (!page.indices.Allocate(indexBytes, 4, indexOffset))
+        {
+            page.vertices.Release(vertexOffset, vertexCount);
+            return nullptr;
+        }
+        GeometryRange *range = new GeometryRange();
+        range->page = p;
+        range->vertexArray = page.vertexArray;
+        range->baseVertex = (GLint) vertexOffset;
+        range->vertexCount = vertexCount;
+        range->indexOffset = indexOffset;
+        range->indexBytes = indexBytes;
+        page.ranges.push_back(unique_ptr<GeometryRange>(range));
+        return range;
+    }
+
+    // the copy targets leave the VAO's element buffer binding alone; indexBytes is the caller's, without the padding
+    GeometryRange *upload(GeometryRange *range, const PackedVertex *vertices, const void *indices, size_t indexBytes)
+    {
+        Page &page = *pages[range->page];
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.vertexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range->baseVertex * sizeof(PackedVertex), range->vertexCount * sizeof(PackedVertex), vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.indexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range->indexOffset, indexBytes, indices);
+        return range;
+    }
+
+    void createPage(Page &page, size_t vertexCapacity, size_t indexCapacity)
+    {
+        glGenVertexArrays(1, &page.vertexArray);
+        page.vertices.Reset(vertexCapacity);
+        page.indices.Reset(indexCapacity);
+        createBuffers(page);
+    }
+
+    // fresh buffers of the page's capacity, attached to its VAO
+    void createBuffers(Page &page)
+    {
+        glGenBuffers(1, &page.vertexBuffer);
+        glGenBuffers(1, &page.indexBuffer);
+        GLState::Get().BindVertexArray(page.vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, page.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, page.vertices.Capacity() * sizeof(PackedVertex), nullptr, GL_STATIC_DRAW);
+        SetupVertexAttributes();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, page.indices.Capacity(), nullptr, GL_STATIC_DRAW);
+        GLState::Get().BindVertexArray(0);
+    }
+
+    size_t compact(Page &page)
+    {
+        unsigned int oldVertices = page.vertexBuffer, oldIndices = page.indexBuffer;
+        createBuffers(page);
+        glBindBuffer(GL_COPY_READ_BUFFER, oldVertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.vertexBuffer);
+        vector<GeometryRange *> ranges;
+        for (unique_ptr<GeometryRange> &range : page.ranges)
+            ranges.push_back(range.get());
+        // front to back so the relative order, and with it what sits next to what, stays the same
+        sort(ranges.begin(), ranges.end(), [](const GeometryRange *a, const GeometryRange *b) { return a->baseVertex < b->baseVertex; });
+        size_t moved = 0, vertexEnd = 0;
+        for (GeometryRange *range : ranges)
+        {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range->baseVertex * sizeof(PackedVertex),
+                                vertexEnd * sizeof(PackedVertex), range->vertexCount * sizeof(PackedVertex));
+            moved += range->vertexCount * sizeof(PackedVertex);
+            range->baseVertex = (GLint) vertexEnd;
+            vertexEnd += range->vertexCount;
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, oldIndices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.indexBuffer);
+        sort(ranges.begin(), ranges.end(), [](const GeometryRange *a, const GeometryRange *b) { return a->indexOffset < b->indexOffset; });
+        size_t indexEnd = 0;
+        for (GeometryRange *range : ranges)
+        {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range->indexOffset, indexEnd, range->indexBytes);
+            moved += range->indexBytes;
+            range->indexOffset = indexEnd;
+            indexEnd += range->indexBytes;
+        }
+
+        page.vertices.Reset(page.vertices.Capacity(), vertexEnd);
+        page.indices.Reset(page.indices.Capacity(), indexEnd);
+        unsigned int buffers[] = {oldVertices, oldIndices};
+        glDeleteBuffers(2, buffers);
+        return moved;
+    }
+};
+
+#endif
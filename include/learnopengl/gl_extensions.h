@@ -0,0 +1,94 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// glad is generated for plain 3.3 core, the few newer entry points the renderer can use when the driver has them
+// are loaded here by hand. everything stays null and the flags false when a feature is missing.
+
+// GL 4.1 / ARB_get_program_binary
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+// GL 4.3 / ARB_multi_draw_indirect, together with the base instance of GL 4.2 / ARB_base_instance
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+struct GLExtensions {
+    bool programBinary = false;
+    GetProgramBinaryProc  GetProgramBinary = nullptr;
+    ProgramBinaryProc     ProgramBinary = nullptr;
+    ProgramParameteriProc ProgramParameteri = nullptr;
+    bool parallelShaderCompile = false;
+    MaxShaderCompilerThreadsProc MaxShaderCompilerThreads = nullptr;
+    bool multiDrawIndirect = false;
+    MultiDrawElementsIndirectProc MultiDrawElementsIndirect = nullptr;
+
+    static GLExtensions &Get()
+    {
+        static GLExtensions extensions;
+        return extensions;
+    }
+
+    // call once after gladLoadGLLoader with the same loader
+    void Load(GLADloadproc load)
+    {
+        GetProgramBinary = (GetProgramBinaryProc) load("glGetProgramBinary");
+        ProgramBinary = (ProgramBinaryProc) load("glProgramBinary");
+        ProgramParameteri = (ProgramParameteriProc) load("glProgramParameteri");
+        GLint formats = 0;
+        if (Supported("GL_ARB_get_program_binary") || Version(4, 1))
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        // a driver may expose the entry points and still offer no format to save programs in
+        programBinary = GetProgramBinary && ProgramBinary && ProgramParameteri && formats > 0;
+
+        // the ARB version has the same enums, only the entry point is named differently
+        if (Supported("GL_KHR_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc) load("glMaxShaderCompilerThreadsKHR");
+        else if (Supported("GL_ARB_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc) load("glMaxShaderCompilerThreadsARB");
+        parallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+        // 0xFFFFFFFF lets the driver pick as many compiler threads as it likes
+        if (parallelShaderCompile)
+            MaxShaderCompilerThreads(0xFFFFFFFF);
+
+        // the per draw data of a multi-draw is read through baseInstance, useless without it
+        MultiDrawElementsIndirect = (MultiDrawElementsIndirectProc) load("glMultiDrawElementsIndirect");
+        multiDrawIndirect = MultiDrawElementsIndirect
+                            && (Version(4, 3) || (Supported("GL_ARB_multi_draw_indirect") && Supported("GL_ARB_base_instance")));
+    }
+
+    static bool Supported(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char *extension = (const char *) glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static bool Version(int major, int minor)
+    {
+        GLint contextMajor = 0, contextMinor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+        glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+        return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+    }
+};
+
+#endif
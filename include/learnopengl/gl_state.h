@@ -0,0 +1,173 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#define GL_STATE_TEXTURE_UNITS 16
+
+// number of state changing calls that reached GL and that were dropped because nothing would have changed
+struct GLStateCounters {
+    unsigned int issued = 0;
+    unsigned int elided = 0;
+};
+
+// shadow copy of the GL state the renderer changes most: program, vertex array, active texture unit, 2D and cubemap
+// bindings per unit, depth func and blending. every change goes through here and calls that would not change
+// anything are filtered out. code that touches this state directly (ImGui, raw gl calls) must call Invalidate().
+// GL thread only.
+class GLState
+{
+public:
+    static GLState &Get()
+    {
+        static GLState state;
+        return state;
+    }
+
+    void UseProgram(unsigned int program)
+    {
+        if (changed(currentProgram, program))
+            glUseProgram(program);
+    }
+
+    void BindVertexArray(unsigned int vao)
+    {
+        if (changed(currentVertexArray, vao))
+            glBindVertexArray(vao);
+    }
+
+    // unit is the index, not GL_TEXTUREi
+    void ActiveTexture(unsigned int unit)
+    {
+        if (changed(currentUnit, unit))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    // binds to the given unit, switching the active unit only when the binding actually changes
+    void BindTexture(unsigned int unit, GLenum target, unsigned int texture)
+    {
+        unsigned int *binding = slot(unit, target);
+        if (binding && *binding == texture)
+        {
+            counters.elided++;
+            return;
+        }
+        ActiveTexture(unit);
+        if (binding)
+            *binding = texture;
+        counters.issued++;
+        glBindTexture(target, texture);
+    }
+
+    // binds to whatever unit is active, for uploads that do not care which unit they go through
+    void BindTexture(GLenum target, unsigned int texture)
+    {
+        if (currentUnit == UNKNOWN)
+            ActiveTexture(0);
+        BindTexture(currentUnit, target, texture);
+    }
+
+    void DepthFunc(GLenum func)
+    {
+        if (changed(currentDepthFunc, func))
+            glDepthFunc(func);
+    }
+
+    void Blend(bool enabled)
+    {
+        if (!changed(currentBlend, enabled ? 1u : 0u))
+            return;
+        if (enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+    }
+
+    void BlendFunc(GLenum source, GLenum destination)
+    {
+        if (currentBlendSource == source && currentBlendDestination == destination)
+        {
+            counters.elided++;
+            return;
+        }
+        currentBlendSource = source;
+        currentBlendDestination = destination;
+        counters.issued++;
+        glBlendFunc(source, destination);
+    }
+
+    // must be called before deleting an object, GL unbinds it and the name may be handed out again
+    void ForgetTexture(unsigned int texture)
+    {
+        for (unsigned int unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++)
+            for (unsigned int &binding : textures[unit])
+                if (binding == texture)
+                    binding = 0;
+    }
+
+    void ForgetVertexArray(unsigned int vao)
+    {
+        if (currentVertexArray == vao)
+            currentVertexArray = 0;
+    }
+
+    void ForgetProgram(unsigned int program)
+    {
+        if (currentProgram == program)
+            currentProgram = UNKNOWN;
+    }
+
+    // forgets everything, the next call of each kind goes through to GL
+    void Invalidate()
+    {
+        currentProgram = currentVertexArray = currentUnit = UNKNOWN;
+        currentDepthFunc = currentBlend = currentBlendSource = currentBlendDestination = UNKNOWN;
+        for (unsigned int unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++)
+            textures[unit][0] = textures[unit][1] = UNKNOWN;
+    }
+
+    // closes the counters of the current frame, LastFrame() reports them until the next EndFrame()
+    void EndFrame()
+    {
+        lastFrame = counters;
+        counters = GLStateCounters();
+    }
+
+    const GLStateCounters &LastFrame() const { return lastFrame; }
+
+private:
+    static const unsigned int UNKNOWN = ~0u;
+
+    unsigned int currentProgram, currentVertexArray, currentUnit;
+    unsigned int currentDepthFunc, currentBlend, currentBlendSource, currentBlendDestination;
+    unsigned int textures[GL_STATE_TEXTURE_UNITS][2]; // GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP
+    GLStateCounters counters, lastFrame;
+
+    GLState() { Invalidate(); }
+
+    bool changed(unsigned int &current, unsigned int value)
+    {
+        if (current == value)
+        {
+            counters.elided++;
+            return false;
+        }
+        current = value;
+        counters.issued++;
+        return true;
+    }
+
+    // untracked units and targets return null and always go through
+    unsigned int *slot(unsigned int unit, GLenum target)
+    {
+        if (unit >= GL_STATE_TEXTURE_UNITS)
+            return nullptr;
+        if (target == GL_TEXTURE_2D)
+            return &textures[unit][0];
+        if (target == GL_TEXTURE_CUBE_MAP)
+            return &textures[unit][1];
+        return nullptr;
+    }
+};
+
+#endif
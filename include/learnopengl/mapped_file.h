@@ -0,0 +1,113 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+using namespace std;
+
+// read-only mapping of a whole file, unmapped when it goes out of scope
+class MappedFile
+{
+public:
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    struct stat info;
+
+    explicit MappedFile(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                data = static_cast<const unsigned char *>(mapped);
+                size = info.st_size;
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile()
+    {
+        if (data)
+            munmap(const_cast<unsigned char *>(data), size);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool valid() const { return data != nullptr; }
+};
+
+// 64-bit FNV-1a, good enough to tell files apart, not meant to resist collisions on purpose
+inline uint64_t hashBytes(const void *bytes, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(bytes);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// the on-disk caches keep one file per key: <directory>/<hash in hex><extension>
+inline string CacheFilePath(const string &directory, uint64_t hash, const char *extension)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx", (unsigned long long) hash);
+    return directory + name + extension;
+}
+
+// mkdir -p; tag names the caller in the error message
+inline bool MakeDirectories(const string &directory, const char *tag)
+{
+    for (size_t slash = directory.find('/'); ; slash = directory.find('/', slash + 1))
+    {
+        string part = directory.substr(0, slash);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            cout << "ERROR::" << tag << ":: cannot create " << part << endl;
+            return false;
+        }
+        if (slash == string::npos)
+            return true;
+    }
+}
+
+// write(ofstream &) fills a temporary file that then replaces target, so a crash never leaves a half written file
+template <typename F>
+bool ReplaceFile(const string &target, F write, const char *tag)
+{
+    string temporary = target + ".tmp";
+    {
+        ofstream out(temporary, ios::binary | ios::trunc);
+        if (out)
+            write(out);
+        if (!out)
+        {
+            cout << "ERROR::" << tag << ":: failed to write " << temporary << endl;
+            return false;
+        }
+    }
+    if (rename(temporary.c_str(), target.c_str()) != 0)
+    {
+        cout << "ERROR::" << tag << ":: failed to replace " << target << endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -6,7 +6,13 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <learnopengl/bvh.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/geometry_arena.h>
+#include <learnopengl/gl_state.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/vertex_format.h>
 
 #include <string>
 #include <vector>
@@ -19,10 +25,8 @@ struct Vertex {
     glm::vec3 Normal;
     // texCoords
     glm::vec2 TexCoords;
-    // tangent
-    glm::vec3 Tangent;
-    // bitangent
-    glm::vec3 Bitangent;
+    // tangent, w is the sign of the bitangent: cross(Normal, Tangent) * w
+    glm::vec4 Tangent;
 };
 
 
@@ -33,6 +37,13 @@ struct Texture {
     string path;
 };
 
+// one material texture as seen by one shader program: the unit it goes to and the sampler uniform pointing at it
+struct SamplerBinding {
+    int unit;
+    int location;
+    unsigned int texture;
+};
+
 class Mesh {
 public:
     // mesh Data
@@ -40,14 +51,33 @@ public:
     vector<unsigned int> indices;
     vector<Texture>      textures;
 
-    unsigned int VAO;
+    // where the vertices and indices are in the GeometryArena; its vertex array is shared with the other meshes
+    // on the same page
+    GeometryRange *geometry = nullptr;
+    // GL_UNSIGNED_SHORT when every index fits in 16 bits, else GL_UNSIGNED_INT; what the element buffer holds
+    GLenum indexType = GL_UNSIGNED_INT;
     std::string glslIdentifierPrefix;
+    // model space bounds of the vertices, for culling
+    Bounds bounds;
+    // ShaderFeature bits the material needs, picks the cheapest shader variant that can draw the mesh
+    unsigned int features = 0;
     // constructor
     Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
     {
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
+        bounds = Bounds::FromPositions((const float *) this->vertices.data(), this->vertices.size(), sizeof(Vertex) / sizeof(float));
+        for(const Texture &texture : this->textures)
+        {
+            if(texture.type == "texture_specular")
+                features |= FEATURE_SPECULAR_MAP;
+            else if(texture.type == "texture_normal")
+                features |= FEATURE_NORMAL_MAP;
+            // exporters point the opacity map at the diffuse texture, the variant tests its alpha
+            else if(texture.type == "texture_opacity")
+                features |= FEATURE_ALPHA_TEST;
+        }
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
@@ -56,17 +86,116 @@ public:
     // render the mesh
     void Draw(Shader &shader)
     {
-        // bind appropriate textures
+        BindMaterial(shader);
+
+        // draw mesh; the VAO and texture units stay bound, GLState knows about them so nothing needs resetting
+        GLState::Get().BindVertexArray(geometry->vertexArray);
+        glDrawElementsBaseVertex(GL_TRIANGLES, indices.size(), indexType, (void*)geometry->indexOffset, geometry->baseVertex);
+    }
+
+    // render count copies in one call, the model matrix of each copy comes from the instance buffer
+    void DrawInstanced(Shader &shader, unsigned int instanceBuffer, unsigned int count)
+    {
+        GeometryArena::Get().BindInstanceBuffer(geometry, instanceBuffer);
+        BindMaterial(shader);
+
+        GLState::Get().BindVertexArray(geometry->vertexArray);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indices.size(), indexType, (void*)geometry->indexOffset, count, geometry->baseVertex);
+    }
+
+    // model space triangle BVH for ray casts, built on first use
+    const TriangleBVH &Triangles()
+    {
+        if(triangles.Empty() && !indices.empty())
+        {
+            vector<glm::vec3> positions(vertices.size());
+            for(size_t i = 0; i < vertices.size(); i++)
+                positions[i] = vertices[i].Position;
+            triangles.Build(positions, indices);
+        }
+        return triangles;
+    }
+
+    // bind appropriate textures; the table is built on the first draw with this shader, so nothing here allocates
+    void BindMaterial(Shader &shader)
+    {
+        const SamplerTable &table = samplerTable(shader);
+        for(const SamplerBinding &binding : table.bindings)
+        {
+            // set the sampler to the correct texture unit
+            glUniform1i(binding.location, binding.unit);
+            // and bind the texture, skipped when the unit already holds it
+            GLState::Get().BindTexture(binding.unit, GL_TEXTURE_2D, binding.texture);
+        }
+        if(table.positionMin >= 0)
+        {
+            glm::vec3 extent = bounds.max - bounds.min;
+            glUniform3f(table.positionMin, bounds.min.x, bounds.min.y, bounds.min.z);
+            glUniform3f(table.positionExtent, extent.x, extent.y, extent.z);
+        }
+    }
+
+    // true when one multi-draw can draw both meshes: same textures under the same sampler names, index type and
+    // arena page, and the same bounds when positions are quantized to them
+    bool Batchable(const Mesh &other) const
+    {
+        if(textures.size() != other.textures.size() || indexType != other.indexType
+           || geometry->vertexArray != other.geometry->vertexArray || glslIdentifierPrefix != other.glslIdentifierPrefix)
+            return false;
+        for(size_t i = 0; i < textures.size(); i++)
+            if(textures[i].id != other.textures[i].id || textures[i].type != other.textures[i].type)
+                return false;
+#if VERTEX_QUANTIZED_POSITIONS
+        if(bounds.min != other.bounds.min || bounds.max != other.bounds.max)
+            return false;
+#endif
+        return true;
+    }
+
+    // gives the mesh's space in the arena back; copies of the mesh must not draw afterwards
+    void Release()
+    {
+        if(geometry)
+            GeometryArena::Get().Free(geometry);
+        geometry = nullptr;
+    }
+
+private:
+    TriangleBVH triangles;
+
+    // sampler bindings per shader program the mesh was drawn with, and the prefix they were built for.
+    // keyed by the shader's revision, so a hot reloaded program gets a new table
+    struct SamplerTable {
+        unsigned int revision;
+        vector<SamplerBinding> bindings;
+        // where the program takes the bounds quantized positions are relative to, -1 without quantization
+        int positionMin = -1, positionExtent = -1;
+    };
+    vector<SamplerTable> samplerTables;
+    string samplerTablesPrefix;
+
+    const SamplerTable &samplerTable(Shader &shader)
+    {
+        if(samplerTablesPrefix != glslIdentifierPrefix)
+        {
+            samplerTables.clear();
+            samplerTablesPrefix = glslIdentifierPrefix;
+        }
+        for(const SamplerTable &table : samplerTables)
+            if(table.revision == shader.revision)
+                return table;
+
+        // the N in diffuse_textureN counts per texture type
+        SamplerTable table;
+        table.revision = shader.revision;
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
         unsigned int heightNr   = 1;
         for(unsigned int i = 0; i < textures.size(); i++)
         {
-            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
             string number;
-            string name = textures[i].type;
+            const string &name = textures[i].type;
             if(name == "texture_diffuse")
                 number = std::to_string(diffuseNr++);
             else if(name == "texture_specular")
@@ -75,65 +204,73 @@ public:
                 number = std::to_string(normalNr++); // transfer unsigned int to stream
             else if(name == "texture_height")
                 number = std::to_string(heightNr++); // transfer unsigned int to stream
-
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (glslIdentifierPrefix + name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            // the lighting programs name their samplers material.*, meshes without a prefix fall back to that.
+            // textures the program does not sample, like the specular map in a variant without one, are not bound
+            UniformHandle sampler = shader.uniform(glslIdentifierPrefix + name + number);
+            if(!sampler.valid() && glslIdentifierPrefix.empty())
+                sampler = shader.uniform("material." + name + number);
+            if(sampler.valid())
+                table.bindings.push_back({(int) i, sampler.location, textures[i].id});
         }
-
-
-
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
+#if VERTEX_QUANTIZED_POSITIONS
+        table.positionMin = shader.uniform("positionMin").location;
+        table.positionExtent = shader.uniform("positionExtent").location;
+#endif
+        samplerTables.push_back(table);
+        return samplerTables.back();
     }
 
-private:
-    // render data
-    unsigned int VBO, EBO;
+    vector<PackedVertex> packVertices() const
+    {
+        vector<PackedVertex> packed(vertices.size());
+#if VERTEX_QUANTIZED_POSITIONS
+        glm::vec3 extent = bounds.max - bounds.min;
+#endif
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex &vertex = vertices[i];
+            PackedVertex &out = packed[i];
+#if VERTEX_QUANTIZED_POSITIONS
+            // flat axes have no extent, everything on them sits at the minimum
+            for(int axis = 0; axis < 3; axis++)
+                out.position[axis] = extent[axis] > 0.0f
+                                     ? (uint16_t) lround((vertex.Position[axis] - bounds.min[axis]) / extent[axis] * 65535.0f) : 0;
+            out.position[3] = 0;
+#else
+            out.position[0] = vertex.Position.x;
+            out.position[1] = vertex.Position.y;
+            out.position[2] = vertex.Position.z;
+#endif
+#if VERTEX_OCTAHEDRAL_NORMALS
+            out.normal = PackOctahedral(vertex.Normal);
+#else
+            out.normal = PackSnorm10x3(vertex.Normal);
+#endif
+            out.tangent = PackSnorm10x3(glm::vec3(vertex.Tangent), vertex.Tangent.w);
+            out.texCoords[0] = PackHalf(vertex.TexCoords.x);
+            out.texCoords[1] = PackHalf(vertex.TexCoords.y);
+        }
+        return packed;
+    }
 
-    // initializes all the buffer objects/arrays
+    // copies the vertices and indices into the geometry arena
     void setupMesh()
     {
-        // create buffers/arrays
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        // load data into vertex buffers
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // A great thing about structs is that their memory layout is sequential for all its items.
-        // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-        // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-        // set the vertex attribute pointers
-        // vertex Positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-        // vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-        // vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
-
-        glBindVertexArray(0);
+        // packed into the GPU layout of vertex_format.h
+        vector<PackedVertex> packed = packVertices();
+        // half the index memory and bandwidth for every mesh small enough, which is most of them. 8-bit indices
+        // would save more but many GPUs widen them on the CPU side of the driver
+        if(vertices.size() <= 65536)
+        {
+            vector<uint16_t> shortIndices(indices.begin(), indices.end());
+            indexType = GL_UNSIGNED_SHORT;
+            geometry = GeometryArena::Get().Allocate(packed.data(), packed.size(), shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+        }
+        else
+        {
+            indexType = GL_UNSIGNED_INT;
+            geometry = GeometryArena::Get().Allocate(packed.data(), packed.size(), indices.data(), indices.size() * sizeof(unsigned int));
+        }
     }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,308 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/texture_registry.h>
+#include <learnopengl/trace.h>
+
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+// bump whenever the layout of the cache file or of Vertex changes, or the material textures collected or the
+// import-time processing of the meshes
+#define MESH_CACHE_VERSION 4
+#define MESH_CACHE_DIRECTORY "resources/cache/meshes"
+
+// texture reference of a material, resolved to a GL texture only when the mesh is created
+struct MeshTextureRef {
+    string type;
+    string path;
+    // inspected by Model::ReadMeshData off the GL thread; not cached, the file may change on its own
+    TextureFileInfo file;
+};
+
+// post-processed mesh data as it comes out of Assimp, before anything is uploaded to the GPU
+struct MeshData {
+    vector<Vertex>         vertices;
+    vector<unsigned int>   indices;
+    vector<MeshTextureRef> textures;
+};
+
+// identifies one source file imported with one set of postprocess flags
+struct MeshCacheKey {
+    string   path;
+    int64_t  mtime = 0;
+    uint64_t size = 0;
+    uint64_t contentHash = 0;
+    uint32_t postprocessFlags = 0;
+};
+
+// on-disk cache of imported models, so warm starts skip Assimp completely.
+// one file per (source path, postprocess flags), validated against the source's mtime, size and content hash.
+// the content hash covers the material libraries an OBJ names with mtllib too, their texture references are cached.
+class MeshCache
+{
+public:
+    struct LoadRecord {
+        string path;
+        bool   fromCache;
+        double milliseconds;
+    };
+
+    static bool MakeKey(const string &path, uint32_t postprocessFlags, MeshCacheKey &key)
+    {
+        MappedFile source(path);
+        if (!source.valid())
+            return false;
+        key.path = path;
+        key.mtime = source.info.st_mtime;
+        key.size = source.size;
+        key.contentHash = hashMaterialLibraries(path, source, hashBytes(source.data, source.size));
+        key.postprocessFlags = postprocessFlags;
+        return true;
+    }
+
+    // maps the cache file once and copies the meshes out of it; returns false on a miss or a stale entry
+    static bool Load(const MeshCacheKey &key, vector<MeshData> &meshes)
+    {
+        TraceScope trace("MeshCache::Load", key.path);
+        MappedFile file(cacheFilePath(key));
+        if (!file.valid())
+            return false;
+
+        Reader in{file.data, file.data + file.size};
+        Header header;
+        if (!in.read(&header, sizeof(header)))
+            return false;
+        if (memcmp(header.magic, magic(), sizeof(header.magic)) != 0 || header.version != MESH_CACHE_VERSION
+            || header.vertexSize != sizeof(Vertex) || header.postprocessFlags != key.postprocessFlags
+            || header.mtime != key.mtime || header.size != key.size || header.contentHash != key.contentHash)
+            return false;
+        string path;
+        if (!in.readString(path, header.pathLength) || path != key.path)
+            return false;
+
+        // counts come from disk, nothing is allocated for more than the rest of the file could hold
+        if (header.meshCount > in.remaining() / (3 * sizeof(uint32_t)))
+            return false;
+        vector<MeshData> loaded(header.meshCount);
+        for (MeshData &mesh : loaded)
+        {
+            uint32_t counts[3];
+            if (!in.read(counts, sizeof(counts)) || counts[2] > in.remaining() / (2 * sizeof(uint32_t)))
+                return false;
+            mesh.textures.resize(counts[2]);
+            for (MeshTextureRef &texture : mesh.textures)
+            {
+                uint32_t lengths[2];
+                if (!in.read(lengths, sizeof(lengths)) || !in.readString(texture.type, lengths[0]) || !in.readString(texture.path, lengths[1]))
+                    return false;
+            }
+            if (!in.align() || (uint64_t) counts[0] * sizeof(Vertex) + (uint64_t) counts[1] * sizeof(unsigned int) > in.remaining())
+                return false;
+            mesh.vertices.resize(counts[0]);
+            mesh.indices.resize(counts[1]);
+            if (!in.read(mesh.vertices.data(), counts[0] * sizeof(Vertex)) || !in.read(mesh.indices.data(), counts[1] * sizeof(unsigned int)))
+                return false;
+        }
+        meshes.swap(loaded);
+        return true;
+    }
+
+    // written through ReplaceFile, a crash never leaves a half written entry behind
+    static void Store(const MeshCacheKey &key, const vector<MeshData> &meshes)
+    {
+        TraceScope trace("MeshCache::Store", key.path);
+        if (!MakeDirectories(MESH_CACHE_DIRECTORY, "MESH_CACHE"))
+            return;
+        ReplaceFile(cacheFilePath(key), [&](ofstream &out) {
+            Header header;
+            memcpy(header.magic, magic(), sizeof(header.magic));
+            header.version = MESH_CACHE_VERSION;
+            header.vertexSize = sizeof(Vertex);
+            header.postprocessFlags = key.postprocessFlags;
+            header.pathLength = key.path.size();
+            header.meshCount = meshes.size();
+            header.mtime = key.mtime;
+            header.size = key.size;
+            header.contentHash = key.contentHash;
+            size_t written = 0;
+            write(out, written, &header, sizeof(header));
+            write(out, written, key.path.data(), key.path.size());
+            for (const MeshData &mesh : meshes)
+            {
+                uint32_t counts[3] = {(uint32_t) mesh.vertices.size(), (uint32_t) mesh.indices.size(), (uint32_t) mesh.textures.size()};
+                write(out, written, counts, sizeof(counts));
+                for (const MeshTextureRef &texture : mesh.textures)
+                {
+                    uint32_t lengths[2] = {(uint32_t) texture.type.size(), (uint32_t) texture.path.size()};
+                    write(out, written, lengths, sizeof(lengths));
+                    write(out, written, texture.type.data(), texture.type.size());
+                    write(out, written, texture.path.data(), texture.path.size());
+                }
+                static const char padding[4] = {0, 0, 0, 0};
+                write(out, written, padding, (4 - written % 4) % 4);
+                write(out, written, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+                write(out, written, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+            }
+        }, "MESH_CACHE");
+    }
+
+    // models may be read on loader threads
+    static void RecordLoad(const string &path, bool fromCache, double milliseconds)
+    {
+        lock_guard<mutex> lock(recordsMutex());
+        records().push_back({path, fromCache, milliseconds});
+    }
+
+    // prints how every model got loaded so far, cache hits against full Assimp parses
+    static void PrintReport()
+    {
+        unsigned int hits = 0, parses = 0;
+        double hitMs = 0.0, parseMs = 0.0;
+        lock_guard<mutex> lock(recordsMutex());
+        for (const LoadRecord &record : records())
+        {
+            cout << "MESH_CACHE:: " << (record.fromCache ? "cache hit    " : "assimp parse ") << record.milliseconds << " ms  " << record.path << endl;
+            if (record.fromCache)
+            {
+                hits++;
+                hitMs += record.milliseconds;
+            }
+            else
+            {
+                parses++;
+                parseMs += record.milliseconds;
+            }
+        }
+        cout << "MESH_CACHE:: " << hits << " cache hits (" << hitMs << " ms), "
+             << parses << " assimp parses (" << parseMs << " ms)" << endl;
+    }
+
+private:
+    // 7 characters plus the terminator fill Header::magic exactly
+    static const char *magic() { return "RGMESH1"; }
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t vertexSize;
+        uint32_t postprocessFlags;
+        uint32_t pathLength;
+        uint32_t meshCount;
+        uint32_t reserved = 0;
+        int64_t  mtime;
+        uint64_t size;
+        uint64_t contentHash;
+    };
+
+    // bounds checked cursor over the mapped cache file
+    struct Reader {
+        const unsigned char *cursor;
+        const unsigned char *end;
+        const unsigned char *begin = cursor;
+
+        bool read(void *destination, size_t size)
+        {
+            if ((size_t) (end - cursor) < size)
+                return false;
+            if (size)
+                memcpy(destination, cursor, size);
+            cursor += size;
+            return true;
+        }
+        bool readString(string &destination, size_t size)
+        {
+            if ((size_t) (end - cursor) < size)
+                return false;
+            destination.assign(reinterpret_cast<const char *>(cursor), size);
+            cursor += size;
+            return true;
+        }
+        size_t remaining() const { return (size_t) (end - cursor); }
+        // skips the padding up to the next multiple of 4; false when the file ends first
+        bool align()
+        {
+            size_t padding = (4 - (cursor - begin) % 4) % 4;
+            if (remaining() < padding)
+                return false;
+            cursor += padding;
+            return true;
+        }
+    };
+
+    static vector<LoadRecord> &records()
+    {
+        static vector<LoadRecord> loads;
+        return loads;
+    }
+
+    static mutex &recordsMutex()
+    {
+        static mutex recordsLock;
+        return recordsLock;
+    }
+
+    static void write(ofstream &out, size_t &written, const void *data, size_t size)
+    {
+        out.write(static_cast<const char *>(data), size);
+        written += size;
+    }
+
+    // folds the contents of every "mtllib" file of an OBJ into hash, a missing one as its name alone so creating it
+    // later misses as well. other formats are returned as they are
+    static uint64_t hashMaterialLibraries(const string &path, const MappedFile &source, uint64_t hash)
+    {
+        if (path.size() < 4 || path.compare(path.size() - 4, 4, ".obj") != 0)
+            return hash;
+        string directory = path.substr(0, path.find_last_of('/') + 1);
+        const char *text = reinterpret_cast<const char *>(source.data);
+        for (size_t line = 0; line < source.size; )
+        {
+            size_t lineEnd = line;
+            while (lineEnd < source.size && text[lineEnd] != '\n')
+                lineEnd++;
+            if (lineEnd - line > 7 && memcmp(text + line, "mtllib", 6) == 0 && isspace((unsigned char) text[line + 6]))
+            {
+                // names are separated by whitespace
+                for (size_t name = line + 6; name < lineEnd; )
+                {
+                    while (name < lineEnd && isspace((unsigned char) text[name]))
+                        name++;
+                    size_t nameEnd = name;
+                    while (nameEnd < lineEnd && !isspace((unsigned char) text[nameEnd]))
+                        nameEnd++;
+                    if (nameEnd > name)
+                    {
+                        string library = directory + string(text + name, nameEnd - name);
+                        hash = hashBytes(library.data(), library.size(), hash);
+                        MappedFile material(library);
+                        if (material.valid())
+                            hash = hashBytes(material.data, material.size, hash);
+                    }
+                    name = nameEnd;
+                }
+            }
+            line = lineEnd + 1;
+        }
+        return hash;
+    }
+
+    // one file per source path and postprocess flags
+    static string cacheFilePath(const MeshCacheKey &key)
+    {
+        uint64_t hash = hashBytes(key.path.data(), key.path.size());
+        return CacheFilePath(MESH_CACHE_DIRECTORY, hashBytes(&key.postprocessFlags, sizeof(key.postprocessFlags), hash), ".mesh");
+    }
+};
+
+#endif
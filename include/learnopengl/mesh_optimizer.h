@@ -0,0 +1,366 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/mesh_cache.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+// post-transform cache entries the optimizer plans for and the statistics simulate, a FIFO of this size
+// is a fair model of what current GPUs reuse within a draw
+#define VERTEX_CACHE_SIZE 16
+// a cluster is closed once its ACMR gets this close to the ACMR of the whole mesh, see splitClusters
+#define OVERDRAW_CLUSTER_THRESHOLD 1.05f
+
+// post-transform cache efficiency of an index order
+struct VertexCacheStats {
+    // vertex shader invocations per triangle, 0.5 at best for a regular grid, 3 without any reuse
+    float acmr = 0.0f;
+    // vertex shader invocations per vertex, 1 is the optimum
+    float atvr = 0.0f;
+};
+
+// import-time pass over a mesh, in this order: welds duplicate vertices, orders the triangles for the post-transform
+// cache (Tipsify, Sander et al. 2007), reorders clusters of those triangles outside in so near geometry is drawn
+// first and hides more, then numbers the vertices in first-use order for fetch locality.
+// runs wherever the model gets imported, loader threads included; the result goes into the mesh cache.
+class MeshOptimizer
+{
+public:
+    struct Record {
+        string           path;
+        unsigned int     mesh;
+        size_t           verticesBefore, verticesAfter;
+        size_t           triangles;
+        VertexCacheStats before, after;
+    };
+
+    static void Optimize(const string &path, unsigned int mesh, MeshData &data)
+    {
+        // line and point meshes Triangulate leaves alone are drawn as they are
+        if (data.indices.size() < 3 || data.indices.size() % 3 != 0 || data.vertices.empty())
+            return;
+        Record record;
+        record.path = path;
+        record.mesh = mesh;
+        record.verticesBefore = data.vertices.size();
+        record.triangles = data.indices.size() / 3;
+        record.before = Analyze(data.indices, data.vertices.size());
+
+        Weld(data.vertices, data.indices);
+        vector<unsigned int> clusters;
+        data.indices = Tipsify(data.indices, data.vertices.size(), VERTEX_CACHE_SIZE, &clusters);
+        OptimizeOverdraw(data.indices, data.vertices, clusters);
+        OptimizeVertexFetch(data.vertices, data.indices);
+
+        record.verticesAfter = data.vertices.size();
+        record.after = Analyze(data.indices, data.vertices.size());
+        lock_guard<mutex> lock(recordsMutex());
+        records().push_back(record);
+    }
+
+    // simulates a FIFO post-transform cache over the triangle list
+    static VertexCacheStats Analyze(const vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+    {
+        VertexCacheStats stats;
+        if (indices.empty())
+            return stats;
+        // a vertex is cached while fewer than cacheSize misses happened since it was loaded
+        vector<size_t> loadedAt(vertexCount, 0);
+        vector<bool> referenced(vertexCount, false);
+        size_t misses = 0, unique = 0;
+        for (unsigned int index : indices)
+        {
+            if (!referenced[index])
+            {
+                referenced[index] = true;
+                unique++;
+            }
+            else if (misses - loadedAt[index] < cacheSize)
+                continue;
+            loadedAt[index] = misses++;
+        }
+        stats.acmr = (float) misses / (indices.size() / 3);
+        stats.atvr = (float) misses / unique;
+        return stats;
+    }
+
+    // merges vertices whose every attribute is bit for bit the same
+    static void Weld(vector<Vertex> &vertices, vector<unsigned int> &indices)
+    {
+        // open addressing over the welded vertices, at most half full so probe runs stay short
+        const unsigned int empty = (unsigned int) -1;
+        size_t tableSize = 1;
+        while (tableSize < vertices.size() * 2)
+            tableSize *= 2;
+        vector<unsigned int> table(tableSize, empty);
+        vector<unsigned int> remap(vertices.size());
+        vector<Vertex> welded;
+        welded.reserve(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            size_t slot = hashBytes(&vertices[i], sizeof(Vertex)) & (tableSize - 1);
+            while (table[slot] != empty && memcmp(&welded[table[slot]], &vertices[i], sizeof(Vertex)) != 0)
+                slot = (slot + 1) & (tableSize - 1);
+            if (table[slot] == empty)
+            {
+                table[slot] = (unsigned int) welded.size();
+                welded.push_back(vertices[i]);
+            }
+            remap[i] = table[slot];
+        }
+        for (unsigned int &index : indices)
+            index = remap[index];
+        vertices.swap(welded);
+    }
+
+    // Tipsify: fans around one vertex at a time, moving on to the neighbour that stays in the cache longest and
+    // still has triangles left. clusters gets the first triangle after every point where the walk had to jump to an
+    // unrelated vertex, the natural cuts for the overdraw pass
+    static vector<unsigned int> Tipsify(const vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize, vector<unsigned int> *clusters = nullptr)
+    {
+        size_t triangleCount = indices.size() / 3;
+        // triangles of every vertex, as offsets into one array
+        vector<unsigned int> live(vertexCount, 0), offsets(vertexCount + 1, 0), adjacency(indices.size());
+        for (unsigned int index : indices)
+            live[index]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+        vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[fill[indices[i]]++] = (unsigned int) (i / 3);
+
+        vector<unsigned int> cacheTime(vertexCount, 0);
+        vector<bool> emitted(triangleCount, false);
+        vector<unsigned int> deadEnds, candidates, output;
+        output.reserve(indices.size());
+        unsigned int time = cacheSize + 1;
+        size_t cursor = 0;
+        int fan = indices.empty() ? -1 : (int) indices[0];
+        if (clusters)
+            clusters->assign(1, 0);
+        while (fan >= 0)
+        {
+            candidates.clear();
+            for (unsigned int a = offsets[fan]; a < offsets[fan + 1]; a++)
+            {
+                unsigned int triangle = adjacency[a];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                for (unsigned int corner = 0; corner < 3; corner++)
+                {
+                    unsigned int v = indices[triangle * 3 + corner];
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - cacheTime[v] > cacheSize)
+                        cacheTime[v] = time++;
+                }
+            }
+
+            // the candidate that is still cached after emitting its remaining triangles, oldest first
+            fan = -1;
+            int best = -1;
+            for (unsigned int v : candidates)
+            {
+                if (live[v] == 0)
+                    continue;
+                int priority = 0;
+                if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                    priority = (int) (time - cacheTime[v]);
+                if (priority > best)
+                {
+                    best = priority;
+                    fan = (int) v;
+                }
+            }
+            if (fan >= 0)
+                continue;
+            // dead end: a recently used vertex with triangles left, else the next one in index order
+            while (!deadEnds.empty() && fan < 0)
+            {
+                unsigned int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[v] > 0)
+                    fan = (int) v;
+            }
+            if (fan >= 0)
+                continue;
+            while (cursor < vertexCount && live[cursor] == 0)
+                cursor++;
+            if (cursor < vertexCount)
+            {
+                fan = (int) cursor;
+                if (clusters)
+                    clusters->push_back((unsigned int) (output.size() / 3));
+            }
+        }
+        return output;
+    }
+
+    // sorts clusters of triangles so those facing away from the mesh's centre, the ones in front from most
+    // directions, come first. only whole clusters move, so the cache order inside each one survives
+    static void OptimizeOverdraw(vector<unsigned int> &indices, const vector<Vertex> &vertices, const vector<unsigned int> &hardClusters)
+    {
+        size_t triangleCount = indices.size() / 3;
+        vector<unsigned int> clusters = splitClusters(indices, vertices.size(), hardClusters);
+        if (clusters.size() < 2)
+            return;
+
+        glm::vec3 meshCentroid(0.0f);
+        for (size_t t = 0; t < triangleCount; t++)
+            meshCentroid += triangleCentroid(indices, vertices, t);
+        meshCentroid /= (float) triangleCount;
+
+        struct Cluster {
+            unsigned int begin, end;
+            float        sortKey;
+        };
+        vector<Cluster> sorted;
+        for (size_t i = 0; i < clusters.size(); i++)
+        {
+            Cluster cluster;
+            cluster.begin = clusters[i];
+            cluster.end = i + 1 < clusters.size() ? clusters[i + 1] : (unsigned int) triangleCount;
+            // area weighted normal and centroid of the cluster
+            glm::vec3 normal(0.0f), centroid(0.0f);
+            float area = 0.0f;
+            for (unsigned int t = cluster.begin; t < cluster.end; t++)
+            {
+                const glm::vec3 &a = vertices[indices[t * 3]].Position;
+                const glm::vec3 &b = vertices[indices[t * 3 + 1]].Position;
+                const glm::vec3 &c = vertices[indices[t * 3 + 2]].Position;
+                glm::vec3 cross = glm::cross(b - a, c - a);
+                float weight = glm::length(cross);
+                normal += cross;
+                centroid += (a + b + c) * (weight / 3.0f);
+                area += weight;
+            }
+            float normalLength = glm::length(normal);
+            cluster.sortKey = area > 0.0f && normalLength > 0.0f
+                              ? glm::dot(centroid / area - meshCentroid, normal / normalLength) : 0.0f;
+            sorted.push_back(cluster);
+        }
+        stable_sort(sorted.begin(), sorted.end(), [](const Cluster &a, const Cluster &b) { return a.sortKey > b.sortKey; });
+
+        vector<unsigned int> reordered;
+        reordered.reserve(indices.size());
+        for (const Cluster &cluster : sorted)
+            reordered.insert(reordered.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+        indices.swap(reordered);
+    }
+
+    // numbers the vertices in the order the triangles first use them, so the vertex fetch streams through the
+    // buffer; vertices no triangle uses are dropped
+    static void OptimizeVertexFetch(vector<Vertex> &vertices, vector<unsigned int> &indices)
+    {
+        const unsigned int unused = (unsigned int) -1;
+        vector<unsigned int> remap(vertices.size(), unused);
+        vector<Vertex> ordered;
+        ordered.reserve(vertices.size());
+        for (unsigned int &index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = (unsigned int) ordered.size();
+                ordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices.swap(ordered);
+    }
+
+    // prints the cache statistics of every mesh optimized so far; meshes read from the mesh cache were optimized
+    // when they were stored and are not listed
+    static void PrintReport()
+    {
+        lock_guard<mutex> lock(recordsMutex());
+        float beforeSum = 0.0f, afterSum = 0.0f;
+        size_t triangles = 0;
+        for (const Record &record : records())
+        {
+            cout << "MESH_OPTIMIZER:: " << record.path << " mesh " << record.mesh << ": " << record.triangles << " triangles, "
+                 << record.verticesBefore << " -> " << record.verticesAfter << " vertices, ACMR " << record.before.acmr
+                 << " -> " << record.after.acmr << ", ATVR " << record.before.atvr << " -> " << record.after.atvr << endl;
+            beforeSum += record.before.acmr * record.triangles;
+            afterSum += record.after.acmr * record.triangles;
+            triangles += record.triangles;
+        }
+        if (triangles > 0)
+            cout << "MESH_OPTIMIZER:: " << records().size() << " meshes optimized, vertex shader invocations per triangle "
+                 << beforeSum / triangles << " -> " << afterSum / triangles << endl;
+        else
+            cout << "MESH_OPTIMIZER:: no meshes imported this run, cached meshes were optimized when stored" << endl;
+    }
+
+private:
+    static vector<Record> &records()
+    {
+        static vector<Record> optimized;
+        return optimized;
+    }
+
+    static mutex &recordsMutex()
+    {
+        static mutex recordsLock;
+        return recordsLock;
+    }
+
+    static glm::vec3 triangleCentroid(const vector<unsigned int> &indices, const vector<Vertex> &vertices, size_t t)
+    {
+        return (vertices[indices[t * 3]].Position + vertices[indices[t * 3 + 1]].Position + vertices[indices[t * 3 + 2]].Position) / 3.0f;
+    }
+
+    // the Tipsify clusters are few and large, each is cut further wherever the ACMR of the part so far, starting
+    // from an empty cache as it will once clusters move, drops to OVERDRAW_CLUSTER_THRESHOLD times the mesh's:
+    // more, smaller clusters to sort at almost no cache cost
+    static vector<unsigned int> splitClusters(const vector<unsigned int> &indices, size_t vertexCount, const vector<unsigned int> &hardClusters)
+    {
+        size_t triangleCount = indices.size() / 3;
+        float meshAcmr = Analyze(indices, vertexCount).acmr;
+        vector<unsigned int> clusters;
+        vector<size_t> loadedAt(vertexCount, 0);
+        vector<bool> seen(vertexCount, false);
+        size_t misses = 0, clusterFirstMiss = 0;
+        for (size_t h = 0; h < hardClusters.size(); h++)
+        {
+            size_t end = h + 1 < hardClusters.size() ? hardClusters[h + 1] : triangleCount;
+            size_t clusterStart = hardClusters[h], clusterMisses = 0;
+            clusters.push_back(hardClusters[h]);
+            clusterFirstMiss = misses;
+            for (size_t t = hardClusters[h]; t < end; t++)
+            {
+                for (unsigned int corner = 0; corner < 3; corner++)
+                {
+                    unsigned int index = indices[t * 3 + corner];
+                    if (seen[index] && loadedAt[index] >= clusterFirstMiss && misses - loadedAt[index] < VERTEX_CACHE_SIZE)
+                        continue;
+                    seen[index] = true;
+                    loadedAt[index] = misses++;
+                    clusterMisses++;
+                }
+                size_t clusterTriangles = t + 1 - clusterStart;
+                if (t + 1 < end && (float) clusterMisses / clusterTriangles <= meshAcmr * OVERDRAW_CLUSTER_THRESHOLD)
+                {
+                    clusters.push_back((unsigned int) (t + 1));
+                    clusterStart = t + 1;
+                    clusterMisses = 0;
+                    clusterFirstMiss = misses;
+                }
+            }
+        }
+        return clusters;
+    }
+};
+
+#endif
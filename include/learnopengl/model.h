@@ -11,8 +11,12 @@
 #include <assimp/postprocess.h>
 
 #include <learnopengl/mesh.h>
+#include <learnopengl/mesh_cache.h>
+#include <learnopengl/mesh_optimizer.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/texture_registry.h>
 
+#include <chrono>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -23,13 +27,17 @@ using namespace std;
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
 
+// postprocessing applied to every imported model, also part of the mesh cache key. welding and cache ordering are
+// left to MeshOptimizer rather than JoinIdenticalVertices and ImproveCacheLocality
+const unsigned int MODEL_POSTPROCESS_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
 
 
 class Model
 {
 public:
     // model data
-    vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
+    vector<Texture> textures_loaded;	// every distinct texture of the model, loading is shared process wide by TextureRegistry
     vector<Mesh>    meshes;
     string directory;
     bool gammaCorrection;
@@ -40,6 +48,11 @@ public:
         loadModel(path);
     }
 
+    // empty model, its meshes are added one by one with AddMesh (see ModelLoader)
+    Model() : gammaCorrection(false)
+    {
+    }
+
     // draws the model, and thus all its meshes
     void Draw(Shader &shader)
     {
@@ -47,33 +60,132 @@ public:
             meshes[i].Draw(shader);
     }
 
+    // draws count copies of the model with one instanced call per mesh. transforms holds the model matrix
+    // of every copy; the shader takes it as a mat4 attribute at INSTANCE_MODEL_ATTRIBUTE instead of a uniform.
+    void DrawInstanced(Shader &shader, const glm::mat4 *transforms, unsigned int count)
+    {
+        if(count == 0)
+            return;
+        if(instanceBuffer == 0)
+            glGenBuffers(1, &instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        // grow when needed, otherwise orphan the storage so the previous frame's draws never stall the upload
+        instanceCapacity = max(instanceCapacity, count);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), transforms);
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].DrawInstanced(shader, instanceBuffer, count);
+    }
+
+    // drops the model's texture references and its instance buffer, GL thread only; the model must not draw afterwards
+    void Delete()
+    {
+        for (unsigned int id : textureReferences)
+            TextureRegistry::Get().Release(id);
+        textureReferences.clear();
+        textures_loaded.clear();
+        if (instanceBuffer != 0)
+            glDeleteBuffers(1, &instanceBuffer);
+        instanceBuffer = 0;
+        instanceCapacity = 0;
+    }
+
     void SetShaderTextureNamePrefix(std::string prefix) {
+        glslIdentifierPrefix = prefix;
         for (Mesh& mesh: meshes) {
             mesh.glslIdentifierPrefix = prefix;
         }
     }
+
+    // material textures are looked up relative to the model file
+    void SetSourcePath(string const &path)
+    {
+        directory = path.substr(0, path.find_last_of('/'));
+    }
+
+    // uploads the mesh data and resolves its texture references to GL textures, GL thread only
+    void AddMesh(const MeshData &data)
+    {
+        meshes.push_back(Mesh(data.vertices, data.indices, loadMaterialTextures(data.textures)));
+        meshes.back().glslIdentifierPrefix = glslIdentifierPrefix;
+    }
+
+    // CPU half of loading a model: reads it from the mesh cache when it is up to date, otherwise imports it
+    // with ASSIMP and refreshes the cache. touches no GL state, so it may run on any thread.
+    static bool ReadMeshData(string const &path, vector<MeshData> &meshData)
+    {
+        TraceScope trace("Model::ReadMeshData", path);
+        auto start = chrono::steady_clock::now();
+        MeshCacheKey key;
+        bool hasKey = MeshCache::MakeKey(path, MODEL_POSTPROCESS_FLAGS, key);
+        bool fromCache = hasKey && MeshCache::Load(key, meshData);
+        if (!fromCache)
+        {
+            if (!importModel(path, meshData))
+                return false;
+            if (hasKey)
+                MeshCache::Store(key, meshData);
+        }
+        inspectTextures(path, meshData);
+        MeshCache::RecordLoad(path, fromCache, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        return true;
+    }
 private:
-    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
+    string glslIdentifierPrefix;
+    // one entry per TextureRegistry reference the meshes hold, duplicates included, released by Delete()
+    vector<unsigned int> textureReferences;
+    // per instance model matrices of DrawInstanced, shared by all meshes
+    unsigned int instanceBuffer = 0;
+    unsigned int instanceCapacity = 0;
+
     void loadModel(string const &path)
     {
-        // read file via ASSIMP
+        SetSourcePath(path);
+        vector<MeshData> meshData;
+        if (!ReadMeshData(path, meshData))
+            return;
+        for (const MeshData &data : meshData)
+            AddMesh(data);
+    }
+
+    // hashes every texture file once here, on the importer thread, so AddMesh only looks them up
+    static void inspectTextures(string const &path, vector<MeshData> &meshData)
+    {
+        TraceScope trace("Model::inspectTextures", path);
+        string directory = path.substr(0, path.find_last_of('/'));
+        map<string, TextureFileInfo> inspected;
+        for (MeshData &mesh : meshData)
+            for (MeshTextureRef &texture : mesh.textures)
+            {
+                auto found = inspected.find(texture.path);
+                if (found == inspected.end())
+                    found = inspected.emplace(texture.path, TextureRegistry::Inspect(directory + '/' + texture.path)).first;
+                texture.file = found->second;
+            }
+    }
+
+    // reads the file via ASSIMP and flattens its node hierarchy into meshData
+    static bool importModel(string const &path, vector<MeshData> &meshData)
+    {
+        TraceScope trace("Model::importModel", path);
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        const aiScene* scene = importer.ReadFile(path, MODEL_POSTPROCESS_FLAGS);
         // check for errors
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
         {
             cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-            return;
+            return false;
         }
-        // retrieve the directory path of the filepath
-        directory = path.substr(0, path.find_last_of('/'));
 
         // process ASSIMP's root node recursively
-        processNode(scene->mRootNode, scene);
+        processNode(scene->mRootNode, scene, meshData);
+        for (unsigned int i = 0; i < meshData.size(); i++)
+            MeshOptimizer::Optimize(path, i, meshData[i]);
+        return true;
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene)
+    static void processNode(aiNode *node, const aiScene *scene, vector<MeshData> &meshData)
     {
         // process each mesh located at the current node
         for(unsigned int i = 0; i < node->mNumMeshes; i++)
@@ -81,27 +193,27 @@ private:
             // the node object only contains indices to index the actual objects in the scene.
             // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+            meshData.push_back(processMesh(mesh, scene));
         }
         // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
         for(unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, meshData);
         }
 
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    static MeshData processMesh(aiMesh *mesh, const aiScene *scene)
     {
         // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
+        MeshData data;
+        vector<Vertex> &vertices = data.vertices;
+        vector<unsigned int> &indices = data.indices;
 
         // walk through each of the mesh's vertices
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
-            Vertex vertex;
+            Vertex vertex = Vertex();
             glm::vec3 vector; // we declare a placeholder vector since assimp_ uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
             // positions
             vector.x = mesh->mVertices[i].x;
@@ -125,19 +237,18 @@ private:
                 vec.x = mesh->mTextureCoords[0][i].x;
                 vec.y = mesh->mTextureCoords[0][i].y;
                 vertex.TexCoords = vec;
-                // tangent
-                vector.x = mesh->mTangents[i].x;
-                vector.y = mesh->mTangents[i].y;
-                vector.z = mesh->mTangents[i].z;
-                vertex.Tangent = vector;
-                // bitangent
-                vector.x = mesh->mBitangents[i].x;
-                vector.y = mesh->mBitangents[i].y;
-                vector.z = mesh->mBitangents[i].z;
-                vertex.Bitangent = vector;
             }
             else
                 vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+            // tangent, the bitangent only survives as the sign of its handedness
+            vertex.Tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+            if (mesh->HasTangentsAndBitangents())
+            {
+                glm::vec3 tangent(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+                glm::vec3 bitangent(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+                float handedness = glm::dot(glm::cross(vertex.Normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+                vertex.Tangent = glm::vec4(tangent, handedness);
+            }
 
             vertices.push_back(vertex);
 
@@ -159,101 +270,66 @@ private:
         // diffuse: texture_diffuseN
         // specular: texture_specularN
         // normal: texture_normalN
-        aiColor3D color(0.0f, 0.0f, 0.0f);
-        material->Get(AI_MATKEY_COLOR_AMBIENT, color);
-
 
         // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        collectMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", data.textures);
         // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        collectMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", data.textures);
         // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        collectMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", data.textures);
         // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-
+        collectMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", data.textures);
+        // 5. opacity maps, only there to turn on the alpha tested shader variant
+        collectMaterialTextures(material, aiTextureType_OPACITY, "texture_opacity", data.textures);
 
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        return data;
     }
 
-    // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    // records the texture paths of a given type, they are only loaded once the mesh gets created
+    static void collectMaterialTextures(aiMaterial *mat, aiTextureType type, const string &typeName, vector<MeshTextureRef> &textures)
     {
-        vector<Texture> textures;
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
-            }
-            if(!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-            }
+            MeshTextureRef texture;
+            texture.type = typeName;
+            texture.path = str.C_Str();
+            textures.push_back(texture);
+        }
+    }
+
+    // acquires the referenced textures from the TextureRegistry, which only loads those nobody loaded yet.
+    // the required info is returned as a Texture struct.
+    vector<Texture> loadMaterialTextures(const vector<MeshTextureRef> &refs)
+    {
+        vector<Texture> textures;
+        for(const MeshTextureRef &ref : refs)
+        {
+            Texture texture;
+            texture.id = TextureRegistry::Get().Acquire2D(this->directory + '/' + ref.path, ref.file);
+            texture.type = ref.type;
+            texture.path = ref.path;
+            textures.push_back(texture);
+            textureReferences.push_back(texture.id);
+            bool seen = false;
+            for (const Texture &loaded : textures_loaded)
+                seen = seen || loaded.id == texture.id;
+            if (!seen)
+                textures_loaded.push_back(texture);
         }
         return textures;
     }
 };
 
 
+// shares the texture through the TextureRegistry; a new one is queued on the TextureLoader and gets its storage
+// once TextureLoader::Upload() sees it decoded
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
 {
     string filename = string(path);
     filename = directory + '/' + filename;
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    return TextureRegistry::Get().Acquire2D(filename);
 }
 #endif
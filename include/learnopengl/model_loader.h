@@ -0,0 +1,228 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/model.h>
+#include <learnopengl/texture_loader.h>
+#include <learnopengl/trace.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+enum ModelLoadState {
+    MODEL_IMPORTING,
+    MODEL_UPLOADING,
+    MODEL_READY,
+    MODEL_FAILED
+};
+
+// a model that is being loaded in the background. the loader thread only ever writes meshData and the bounds,
+// and publishes them by switching the state to MODEL_UPLOADING; everything else belongs to the GL thread.
+class AsyncModel
+{
+public:
+    Model  model;
+    string path;
+    // model space bounds of all meshes, valid from MODEL_UPLOADING on
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    ModelLoadState State() const { return state.load(memory_order_acquire); }
+    bool Ready() const { return State() == MODEL_READY; }
+    bool HasBounds() const { return State() == MODEL_UPLOADING || State() == MODEL_READY; }
+
+private:
+    friend class ModelLoader;
+    atomic<ModelLoadState> state{MODEL_IMPORTING};
+    vector<MeshData>       meshData;
+    size_t                 uploadedMeshes = 0;
+};
+
+typedef shared_ptr<AsyncModel> ModelHandle;
+
+// loads models without blocking the render loop: importing runs on a thread per model,
+// uploading is spread over frames by Update() under a time budget.
+class ModelLoader
+{
+public:
+    typedef chrono::steady_clock Clock;
+
+    ModelHandle Load(const string &path)
+    {
+        ModelHandle handle = make_shared<AsyncModel>();
+        handle->path = path;
+        handle->model.SetSourcePath(path);
+        models.push_back(handle);
+        importers.emplace_back(&ModelLoader::import, handle);
+        return handle;
+    }
+
+    // GL thread, once per frame: uploads decoded textures and imported meshes, one at a time, until the budget
+    // is used up. at least one item goes up per call so loading always makes progress.
+    void Update(double budgetMilliseconds)
+    {
+        Clock::time_point start = Clock::now();
+        do
+        {
+            if (TextureLoader::Get().Upload(1))
+                continue;
+            if (!uploadNextMesh())
+                break;
+        } while (chrono::duration<double, milli>(Clock::now() - start).count() < budgetMilliseconds);
+
+        for (ModelHandle &handle : models)
+        {
+            if (handle->State() != MODEL_UPLOADING || handle->uploadedMeshes < handle->meshData.size())
+                continue;
+            bool texturesReady = true;
+            for (const Texture &texture : handle->model.textures_loaded)
+                texturesReady = texturesReady && !TextureLoader::Get().Pending(texture.id);
+            if (texturesReady)
+            {
+                vector<MeshData>().swap(handle->meshData);
+                handle->state.store(MODEL_READY, memory_order_release);
+            }
+        }
+    }
+
+    // true once every model is ready (or failed) and every queued texture is uploaded
+    bool Idle()
+    {
+        for (ModelHandle &handle : models)
+            if (handle->State() == MODEL_IMPORTING || handle->State() == MODEL_UPLOADING)
+                return false;
+        return TextureLoader::Get().Idle();
+    }
+
+    // releases the GL side of every model, GL thread only
+    void Delete()
+    {
+        for (ModelHandle &handle : models)
+            handle->model.Delete();
+    }
+
+    ~ModelLoader()
+    {
+        for (thread &importer : importers)
+            importer.join();
+    }
+
+private:
+    vector<ModelHandle> models;
+    vector<thread>      importers;
+
+    static void import(ModelHandle handle)
+    {
+        Trace::Get().SetThreadName("model importer");
+        vector<MeshData> meshData;
+        if (!Model::ReadMeshData(handle->path, meshData))
+        {
+            handle->state.store(MODEL_FAILED, memory_order_release);
+            return;
+        }
+        bool first = true;
+        for (const MeshData &mesh : meshData)
+        {
+            for (const Vertex &vertex : mesh.vertices)
+            {
+                handle->boundsMin = first ? vertex.Position : glm::min(handle->boundsMin, vertex.Position);
+                handle->boundsMax = first ? vertex.Position : glm::max(handle->boundsMax, vertex.Position);
+                first = false;
+            }
+        }
+        handle->meshData.swap(meshData);
+        handle->state.store(MODEL_UPLOADING, memory_order_release);
+    }
+
+    bool uploadNextMesh()
+    {
+        for (ModelHandle &handle : models)
+        {
+            if (handle->State() == MODEL_UPLOADING && handle->uploadedMeshes < handle->meshData.size())
+            {
+                TraceScope trace("ModelLoader::uploadMesh", handle->path);
+                handle->model.AddMesh(handle->meshData[handle->uploadedMeshes++]);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// flat shaded box drawn in place of a model until it is ready
+class ModelPlaceholder
+{
+public:
+    // model matrix of the box covering the model's bounds; transform is the model's own model matrix.
+    // false while the bounds are not known yet.
+    bool Box(const AsyncModel &model, const glm::mat4 &transform, glm::mat4 &box) const
+    {
+        if (!model.HasBounds())
+            return false;
+        glm::vec3 center = (model.boundsMin + model.boundsMax) * 0.5f;
+        glm::vec3 size = model.boundsMax - model.boundsMin;
+        box = glm::scale(glm::translate(transform, center), size);
+        return true;
+    }
+
+    // unit cube of 36 vertices with positions and normals, created on first use
+    unsigned int VertexArray()
+    {
+        if (VAO == 0)
+            setupBox();
+        return VAO;
+    }
+
+    void Delete()
+    {
+        if (VAO == 0)
+            return;
+        GLState::Get().ForgetVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        VAO = VBO = 0;
+    }
+
+private:
+    unsigned int VAO = 0, VBO = 0;
+
+    void setupBox()
+    {
+        // unit cube centered at the origin: positions and face normals
+        const float vertices[] = {
+                -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,   0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,   0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+                 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,   0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,   0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+                 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+                -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+                -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+                 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,   0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,   0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+                 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,   0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,   0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,   0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,   0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+                 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+                -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,   0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,   0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+                 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f
+        };
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        GLState::Get().BindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+        GLState::Get().BindVertexArray(0);
+    }
+};
+
+#endif
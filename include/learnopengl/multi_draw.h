@@ -0,0 +1,123 @@
+#ifndef MULTI_DRAW_H
+#define MULTI_DRAW_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/geometry_arena.h>
+#include <learnopengl/gl_extensions.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/mesh.h>
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// one draw of glMultiDrawElementsIndirect, laid out as GL reads it from the indirect buffer
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+// the draws of a frame's batches in one indirect buffer and one buffer of per draw model matrices, uploaded once
+// per frame. a batch is a run of meshes that share program, material and arena page: with multi-draw indirect it
+// is one glMultiDrawElementsIndirect whatever the transforms, the shader reading each draw's matrix as an instance
+// attribute through baseInstance. GL 3.3 has no way for a shader to tell the draws of a multi-draw apart, there a
+// batch is one glMultiDrawElementsBaseVertex over meshes that also share their transform, the model uniform.
+class MultiDraw
+{
+public:
+    // true when batches may mix transforms
+    static bool Indirect() { return GLExtensions::Get().multiDrawIndirect; }
+
+    void Begin()
+    {
+        commands.clear();
+        transforms.clear();
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+    }
+
+    // appends a draw; the draws of a batch have to be added one after another. returns its index
+    unsigned int Add(const Mesh &mesh, const glm::mat4 &transform)
+    {
+        GLuint indexSize = mesh.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        DrawElementsIndirectCommand command;
+        command.count = (GLuint) mesh.indices.size();
+        command.instanceCount = 1;
+        command.firstIndex = (GLuint) (mesh.geometry->indexOffset / indexSize);
+        command.baseVertex = mesh.geometry->baseVertex;
+        command.baseInstance = (GLuint) commands.size();
+        commands.push_back(command);
+        transforms.push_back(transform);
+        counts.push_back((GLsizei) command.count);
+        offsets.push_back((const void *) mesh.geometry->indexOffset);
+        baseVertices.push_back(command.baseVertex);
+        return command.baseInstance;
+    }
+
+    // sends the frame's commands and matrices to the GPU, orphaning last frame's storage
+    void Upload()
+    {
+        if (!Indirect() || commands.empty())
+            return;
+        if (commandBuffer == 0)
+        {
+            glGenBuffers(1, &commandBuffer);
+            glGenBuffers(1, &transformBuffer);
+        }
+        capacity = max(capacity, commands.size());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_ARRAY_BUFFER, transformBuffer);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, transforms.size() * sizeof(glm::mat4), transforms.data());
+    }
+
+    // draws [first, first + count) with one call; mesh is any mesh of the batch, its page and index type are theirs
+    void Draw(const Mesh &mesh, unsigned int first, unsigned int count)
+    {
+        if (Indirect())
+        {
+            GeometryArena::Get().BindInstanceBuffer(mesh.geometry, transformBuffer);
+            GLState::Get().BindVertexArray(mesh.geometry->vertexArray);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            GLExtensions::Get().MultiDrawElementsIndirect(GL_TRIANGLES, mesh.indexType,
+                                                          (const void *) (first * sizeof(DrawElementsIndirectCommand)), count, 0);
+        }
+        else
+        {
+            GLState::Get().BindVertexArray(mesh.geometry->vertexArray);
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data() + first, mesh.indexType, offsets.data() + first,
+                                          count, baseVertices.data() + first);
+        }
+    }
+
+    void Delete()
+    {
+        if (commandBuffer == 0)
+            return;
+        unsigned int buffers[] = {commandBuffer, transformBuffer};
+        glDeleteBuffers(2, buffers);
+        commandBuffer = transformBuffer = 0;
+        capacity = 0;
+    }
+
+private:
+    unsigned int                        commandBuffer = 0, transformBuffer = 0;
+    size_t                              capacity = 0;
+    vector<DrawElementsIndirectCommand> commands;
+    vector<glm::mat4>                   transforms;
+    // the same draws as arrays for glMultiDrawElementsBaseVertex
+    vector<GLsizei>                     counts;
+    vector<const void *>                offsets;
+    vector<GLint>                       baseVertices;
+};
+
+#endif
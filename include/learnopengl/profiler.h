@@ -0,0 +1,186 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/trace.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+// frames a GPU query result may take to arrive; results are read this many frames after they were issued,
+// by then they are available and reading them does not stall
+#define PROFILER_FRAMES 3
+// frames kept for the frame time graphs
+#define PROFILER_HISTORY 120
+
+// timings of one named zone, smoothed over the last frames
+struct ProfilerZoneStats {
+    const char *name;
+    float       cpuMilliseconds = 0.0f;
+    float       gpuMilliseconds = 0.0f;
+};
+
+// named zones timed on the CPU with a steady clock and on the GPU with GL_TIME_ELAPSED queries.
+// GL allows one time elapsed query at a time, so only zones opened while no other zone is open get GPU times;
+// nested zones are CPU only. zones are looked up by name, which must be a string literal or outlive the profiler.
+// every zone and frame also goes into the trace. GL thread only, BeginFrame() and EndFrame() bracket every frame.
+class Profiler
+{
+public:
+    static Profiler &Get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // collects the GPU results of the frame issued PROFILER_FRAMES ago and starts timing a new one
+    void BeginFrame()
+    {
+        Clock::time_point now = Clock::now();
+        if (frame > 0)
+            push(frameMilliseconds, chrono::duration<float, milli>(now - frameStart).count());
+        frameStart = now;
+        frameTraceBegin = Trace::Get().Now();
+        slot = frame % PROFILER_FRAMES;
+
+        float gpuTotal = 0.0f;
+        bool gpuComplete = frame >= PROFILER_FRAMES;
+        for (Zone &zone : zones)
+        {
+            if (!zone.issued[slot])
+                continue;
+            GLint available = 0;
+            glGetQueryObjectiv(zone.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                gpuComplete = false;
+                continue;
+            }
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(zone.queries[slot], GL_QUERY_RESULT, &nanoseconds);
+            zone.issued[slot] = false;
+            float milliseconds = nanoseconds / 1000000.0f;
+            smooth(zone.stats.gpuMilliseconds, milliseconds);
+            gpuTotal += milliseconds;
+        }
+        if (gpuComplete)
+            push(gpuMilliseconds, gpuTotal);
+        for (Zone &zone : zones)
+            zone.used = false;
+    }
+
+    void EndFrame()
+    {
+        Trace::Get().Record("frame", frameTraceBegin, Trace::Get().Now());
+        frame++;
+    }
+
+    void Begin(const char *name)
+    {
+        Zone &zone = find(name);
+        zone.start = Clock::now();
+        zone.traceBegin = Trace::Get().Now();
+        zone.timingGpu = false;
+        // one query per zone and frame, a zone opened twice in a frame is only timed on the GPU the first time
+        if (!gpuBusy && !zone.used)
+        {
+            if (zone.queries[0] == 0)
+                glGenQueries(PROFILER_FRAMES, zone.queries);
+            glBeginQuery(GL_TIME_ELAPSED, zone.queries[slot]);
+            zone.issued[slot] = true;
+            zone.timingGpu = true;
+            gpuBusy = true;
+        }
+        zone.used = true;
+        open.push_back(&zone - zones.data());
+    }
+
+    void End()
+    {
+        Zone &zone = zones[open.back()];
+        open.pop_back();
+        smooth(zone.stats.cpuMilliseconds, chrono::duration<float, milli>(Clock::now() - zone.start).count());
+        Trace::Get().Record(zone.stats.name, zone.traceBegin, Trace::Get().Now());
+        if (zone.timingGpu)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            gpuBusy = false;
+        }
+    }
+
+    vector<ProfilerZoneStats> Zones() const
+    {
+        vector<ProfilerZoneStats> stats;
+        for (const Zone &zone : zones)
+            stats.push_back(zone.stats);
+        return stats;
+    }
+
+    // oldest first, PROFILER_HISTORY entries
+    const float *FrameMilliseconds() const { return frameMilliseconds; }
+    const float *GpuMilliseconds() const { return gpuMilliseconds; }
+
+private:
+    typedef chrono::steady_clock Clock;
+
+    struct Zone {
+        ProfilerZoneStats stats;
+        unsigned int      queries[PROFILER_FRAMES] = {};
+        bool              issued[PROFILER_FRAMES] = {};
+        bool              used = false;
+        bool              timingGpu = false;
+        Clock::time_point start;
+        uint64_t          traceBegin = 0;
+    };
+
+    // zones are never removed, so indices stay valid; open holds the zones begun and not yet ended
+    vector<Zone>      zones;
+    vector<size_t>    open;
+    bool              gpuBusy = false;
+    unsigned int      frame = 0;
+    unsigned int      slot = 0;
+    Clock::time_point frameStart;
+    uint64_t          frameTraceBegin = 0;
+    float             frameMilliseconds[PROFILER_HISTORY] = {};
+    float             gpuMilliseconds[PROFILER_HISTORY] = {};
+
+    Profiler() {}
+
+    Zone &find(const char *name)
+    {
+        for (Zone &zone : zones)
+            if (zone.stats.name == name || strcmp(zone.stats.name, name) == 0)
+                return zone;
+        zones.push_back(Zone());
+        zones.back().stats.name = name;
+        return zones.back();
+    }
+
+    static void push(float *history, float value)
+    {
+        memmove(history, history + 1, (PROFILER_HISTORY - 1) * sizeof(float));
+        history[PROFILER_HISTORY - 1] = value;
+    }
+
+    // exponential moving average over roughly the last ten frames
+    static void smooth(float &average, float value)
+    {
+        average = average == 0.0f ? value : average + (value - average) * 0.1f;
+    }
+};
+
+// times the enclosing scope as a profiler zone
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name) { Profiler::Get().Begin(name); }
+    ~ProfileZone() { Profiler::Get().End(); }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+};
+
+#endif
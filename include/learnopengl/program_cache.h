@@ -0,0 +1,166 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+#include <learnopengl/mapped_file.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// bump whenever the layout of the cache file changes
+#define PROGRAM_CACHE_VERSION 1
+#define PROGRAM_CACHE_DIRECTORY "resources/cache/programs"
+
+// on-disk cache of linked programs as glGetProgramBinary blobs, so warm starts skip compiling and linking.
+// keyed by a hash of the sources, the defines and the driver's vendor, renderer and version strings; the driver
+// may still reject a blob (after an update that kept its version string, say), then the caller compiles from source.
+// does nothing when the driver has no program binary formats. GL thread only.
+class ProgramCache
+{
+public:
+    struct LoadRecord {
+        string name;
+        bool   fromCache;
+        double milliseconds;
+    };
+
+    static uint64_t Key(const vector<string> &sources, const string &defines)
+    {
+        uint64_t hash = hashBytes(defines.data(), defines.size());
+        for (const string &source : sources)
+        {
+            uint64_t length = source.size();
+            hash = hashBytes(&length, sizeof(length), hash);
+            hash = hashBytes(source.data(), source.size(), hash);
+        }
+        const string &driver = driverString();
+        return hashBytes(driver.data(), driver.size(), hash);
+    }
+
+    // call before linking a program that is going to be stored
+    static void PrepareLink(unsigned int program)
+    {
+        if (GLExtensions::Get().programBinary)
+            GLExtensions::Get().ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // loads the cached binary into an empty program object; false on a miss or when the driver rejects the blob
+    static bool Load(uint64_t key, unsigned int program)
+    {
+        if (!GLExtensions::Get().programBinary)
+            return false;
+        MappedFile file(CacheFilePath(PROGRAM_CACHE_DIRECTORY, key, ".program"));
+        if (!file.valid() || file.size < sizeof(Header))
+            return false;
+        Header header;
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, magic(), sizeof(header.magic)) != 0 || header.version != PROGRAM_CACHE_VERSION
+            || header.key != key || header.length != file.size - sizeof(Header))
+            return false;
+        GLExtensions::Get().ProgramBinary(program, header.format, file.data + sizeof(Header), header.length);
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        return linked == GL_TRUE;
+    }
+
+    // writes the binary of a linked program, to a temporary file first so a crash never leaves half an entry
+    static void Store(uint64_t key, unsigned int program)
+    {
+        if (!GLExtensions::Get().programBinary || !MakeDirectories(PROGRAM_CACHE_DIRECTORY, "PROGRAM_CACHE"))
+            return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        vector<char> binary(length);
+        Header header;
+        memcpy(header.magic, magic(), sizeof(header.magic));
+        header.version = PROGRAM_CACHE_VERSION;
+        header.key = key;
+        GLsizei written = 0;
+        GLenum format = 0;
+        GLExtensions::Get().GetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+        header.format = format;
+        header.length = written;
+
+        ReplaceFile(CacheFilePath(PROGRAM_CACHE_DIRECTORY, key, ".program"), [&](ofstream &out) {
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(binary.data(), written);
+        }, "PROGRAM_CACHE");
+    }
+
+    static void RecordLoad(const string &name, bool fromCache, double milliseconds)
+    {
+        records().push_back({name, fromCache, milliseconds});
+    }
+
+    // prints how every program got built so far, cache hits against source compiles
+    static void PrintReport()
+    {
+        unsigned int hits = 0, compiles = 0;
+        double hitMs = 0.0, compileMs = 0.0;
+        for (const LoadRecord &record : records())
+        {
+            cout << "PROGRAM_CACHE:: " << (record.fromCache ? "cache hit      " : "source compile ") << record.milliseconds << " ms  " << record.name << endl;
+            if (record.fromCache)
+            {
+                hits++;
+                hitMs += record.milliseconds;
+            }
+            else
+            {
+                compiles++;
+                compileMs += record.milliseconds;
+            }
+        }
+        cout << "PROGRAM_CACHE:: " << hits << " cache hits (" << hitMs << " ms), "
+             << compiles << " source compiles (" << compileMs << " ms)"
+             << (GLExtensions::Get().programBinary ? "" : ", program binaries not supported by the driver") << endl;
+    }
+
+private:
+    // 7 characters plus the terminator fill Header::magic exactly
+    static const char *magic() { return "RGPROG1"; }
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t format;
+        uint64_t key;
+        uint64_t length;
+    };
+
+    static vector<LoadRecord> &records()
+    {
+        static vector<LoadRecord> loads;
+        return loads;
+    }
+
+    // a new driver, or the same one on other hardware, produces different binaries
+    static const string &driverString()
+    {
+        static string driver;
+        if (driver.empty())
+        {
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+            {
+                const char *value = (const char *) glGetString(name);
+                driver += value ? value : "";
+                driver += '\n';
+            }
+        }
+        return driver;
+    }
+};
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/gl_state.h>
+#include <learnopengl/mesh.h>
+#include <learnopengl/multi_draw.h>
+#include <learnopengl/profiler.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+// passes run in this order, each one completely before the next
+enum RenderPass {
+    PASS_OPAQUE      = 0,
+    PASS_SKYBOX      = 1,
+    PASS_TRANSPARENT = 2
+};
+
+// profiler zone of each pass
+const char *const RENDER_PASS_NAMES[] = {"models", "skybox", "transparent"};
+
+// everything needed to issue one draw. with mesh set the mesh draws itself with its own material,
+// otherwise vertexArray is drawn with texture bound to unit 0.
+struct DrawPacket {
+    RenderPass    pass = PASS_OPAQUE;
+    Shader       *shader = nullptr;
+    Mesh         *mesh = nullptr;
+    unsigned int  vertexArray = 0;
+    unsigned int  texture = 0;
+    GLenum        textureTarget = GL_TEXTURE_2D;
+    unsigned int  count = 0;
+    bool          indexed = false;
+    // type of the indices in the element buffer of vertexArray, meshes keep their own in Mesh::indexType
+    GLenum        indexType = GL_UNSIGNED_INT;
+    GLenum        depthFunc = GL_LESS;
+    UniformHandle modelUniform;
+    glm::mat4     transform = glm::mat4(1.0f);
+    // the same program taking the model matrix from the per draw buffer of a multi-draw indirect batch
+    // (INSTANCE_MODEL_ATTRIBUTE) instead of modelUniform; mesh packets without it are never batched that way
+    Shader       *batchShader = nullptr;
+};
+
+// collects the draws of a frame, orders them by a 64 bit key and issues them through GLState.
+// key layout, most significant bits first:
+//   opaque, skybox  pass:2 | program:10 | material:16 | vertex array:12 | depth:24   state first, then front to back
+//   transparent     pass:2 | ~depth:24 | program:10 | material:16 | vertex array:12  back to front
+// ids are truncated to their field, a collision only costs sort quality, never correctness.
+class RenderQueue
+{
+public:
+    // starts a new frame; depth is the distance from the camera, quantized over [0, farPlane]
+    void Begin(const glm::vec3 &cameraPosition, float farPlane)
+    {
+        this->cameraPosition = cameraPosition;
+        this->farPlane = farPlane;
+        packets.clear();
+        keys.clear();
+    }
+
+    void Submit(const DrawPacket &packet)
+    {
+        keys.push_back(key(packet));
+        packets.push_back(packet);
+    }
+
+    // LSD radix sort over the keys, 8 bits per pass; passes where every key has the same byte are skipped
+    void Sort()
+    {
+        size_t count = keys.size();
+        order.resize(count);
+        for (size_t i = 0; i < count; i++)
+            order[i] = (uint32_t) i;
+        scratchKeys.resize(count);
+        scratchOrder.resize(count);
+
+        uint32_t histograms[8][256] = {};
+        for (uint64_t key : keys)
+            for (unsigned int digit = 0; digit < 8; digit++)
+                histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+
+        for (unsigned int digit = 0; digit < 8; digit++)
+        {
+            uint32_t *histogram = histograms[digit];
+            if (count == 0 || histogram[(keys[0] >> (digit * 8)) & 0xFF] == count)
+                continue;
+            uint32_t offset = 0;
+            for (unsigned int bucket = 0; bucket < 256; bucket++)
+            {
+                uint32_t size = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += size;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t slot = histogram[(keys[i] >> (digit * 8)) & 0xFF]++;
+                scratchKeys[slot] = keys[i];
+                scratchOrder[slot] = order[i];
+            }
+            keys.swap(scratchKeys);
+            order.swap(scratchOrder);
+        }
+    }
+
+    // issues the sorted draws, each pass in its own profiler zone; Sort() must have run since the last Submit()
+    void Execute()
+    {
+        GLState &state = GLState::Get();
+        Profiler &profiler = Profiler::Get();
+        int pass = -1;
+        triangles = 0;
+        calls = 0;
+        prepareBatches();
+        size_t nextBatch = 0;
+        for (size_t position = 0; position < order.size(); position++)
+        {
+            DrawPacket &packet = packets[order[position]];
+            if (packet.pass != pass)
+            {
+                if (pass >= 0)
+                    profiler.End();
+                pass = packet.pass;
+                profiler.Begin(RENDER_PASS_NAMES[pass]);
+            }
+            state.DepthFunc(packet.depthFunc);
+            if (nextBatch < batches.size() && batches[nextBatch].position == position)
+            {
+                const Batch &batch = batches[nextBatch++];
+                drawBatch(batch);
+                position += batch.count - 1;
+                continue;
+            }
+            packet.shader->use();
+            if (packet.modelUniform.valid())
+                packet.shader->setMat4(packet.modelUniform, packet.transform);
+            calls++;
+            if (packet.mesh)
+            {
+                packet.mesh->Draw(*packet.shader);
+                triangles += packet.mesh->indices.size() / 3;
+                continue;
+            }
+            if (packet.texture)
+                state.BindTexture(0, packet.textureTarget, packet.texture);
+            state.BindVertexArray(packet.vertexArray);
+            if (packet.indexed)
+                glDrawElements(GL_TRIANGLES, packet.count, packet.indexType, 0);
+            else
+                glDrawArrays(GL_TRIANGLES, 0, packet.count);
+            triangles += packet.count / 3;
+        }
+        if (pass >= 0)
+            profiler.End();
+        state.DepthFunc(GL_LESS);
+    }
+
+    size_t Size() const { return packets.size(); }
+
+    // draw calls the last Execute() issued, a multi-draw counting once
+    size_t Calls() const { return calls; }
+
+    // merges runs of opaque meshes into multi-draws, see MultiDraw
+    void SetBatching(bool enabled) { batching = enabled; }
+    bool Batching() const { return batching; }
+
+    void Delete() { multiDraw.Delete(); }
+
+    // triangles drawn by the last Execute()
+    size_t Triangles() const { return triangles; }
+
+    // sorted keys, valid after Sort()
+    const vector<uint64_t> &Keys() const { return keys; }
+
+private:
+    vector<DrawPacket> packets;
+    vector<uint64_t>   keys, scratchKeys;
+    vector<uint32_t>   order, scratchOrder;
+    glm::vec3          cameraPosition = glm::vec3(0.0f);
+    float              farPlane = 100.0f;
+    size_t             triangles = 0, calls = 0;
+    bool               batching = true;
+
+    // order[position, position + count) drawn as draws [first, first + count) of multiDraw
+    struct Batch {
+        size_t       position;
+        unsigned int count;
+        unsigned int first;
+    };
+    vector<Batch>      batches;
+    MultiDraw          multiDraw;
+
+    // true when b can join a batch that starts with a
+    bool batchable(const DrawPacket &a, const DrawPacket &b) const
+    {
+        if (a.pass != PASS_OPAQUE || b.pass != PASS_OPAQUE || !a.mesh || !b.mesh || a.shader != b.shader
+            || a.depthFunc != b.depthFunc || !a.mesh->Batchable(*b.mesh))
+            return false;
+        if (MultiDraw::Indirect())
+            return a.batchShader && a.batchShader == b.batchShader;
+        return memcmp(&a.transform, &b.transform, sizeof(glm::mat4)) == 0;
+    }
+
+    // finds the runs of the sorted packets that can be drawn together and uploads their draws
+    void prepareBatches()
+    {
+        batches.clear();
+        multiDraw.Begin();
+        if (!batching)
+            return;
+        for (size_t position = 0; position < order.size(); )
+        {
+            const DrawPacket &first = packets[order[position]];
+            size_t end = position + 1;
+            while (end < order.size() && batchable(first, packets[order[end]]))
+                end++;
+            if (end - position > 1)
+            {
+                Batch batch;
+                batch.position = position;
+                batch.count = (unsigned int) (end - position);
+                batch.first = multiDraw.Add(*first.mesh, first.transform);
+                for (size_t other = position + 1; other < end; other++)
+                    multiDraw.Add(*packets[order[other]].mesh, packets[order[other]].transform);
+                batches.push_back(batch);
+            }
+            position = end;
+        }
+        multiDraw.Upload();
+    }
+
+    void drawBatch(const Batch &batch)
+    {
+        DrawPacket &packet = packets[order[batch.position]];
+        Shader *shader = packet.shader;
+        if (MultiDraw::Indirect())
+            shader = packet.batchShader;
+        shader->use();
+        // every draw of a GL 3.3 batch has this transform
+        if (!MultiDraw::Indirect() && packet.modelUniform.valid())
+            shader->setMat4(packet.modelUniform, packet.transform);
+        packet.mesh->BindMaterial(*shader);
+        multiDraw.Draw(*packet.mesh, batch.first, batch.count);
+        calls++;
+        for (size_t position = batch.position; position < batch.position + batch.count; position++)
+            triangles += packets[order[position]].mesh->indices.size() / 3;
+    }
+
+    uint64_t key(const DrawPacket &packet) const
+    {
+        float distance = glm::length(glm::vec3(packet.transform[3]) - cameraPosition) / farPlane;
+        uint64_t depth = (uint64_t) (glm::clamp(distance, 0.0f, 1.0f) * 0xFFFFFF);
+        uint64_t program = packet.shader->ID & 0x3FF;
+        uint64_t material, vertexArray;
+        if (packet.mesh)
+        {
+            material = packet.mesh->textures.empty() ? 0 : packet.mesh->textures[0].id & 0xFFFF;
+            vertexArray = packet.mesh->geometry->vertexArray & 0xFFF;
+        }
+        else
+        {
+            material = packet.texture & 0xFFFF;
+            vertexArray = packet.vertexArray & 0xFFF;
+        }
+        uint64_t state = program << 28 | material << 12 | vertexArray;
+        if (packet.pass == PASS_TRANSPARENT)
+            return (uint64_t) packet.pass << 62 | (0xFFFFFF - depth) << 38 | state;
+        return (uint64_t) packet.pass << 62 | state << 24 | depth;
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SCENE_TREE_H
+#define SCENE_TREE_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/bvh.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/mesh.h>
+
+#include <vector>
+using namespace std;
+
+// closest mesh a ray hit; item is -1 on a miss
+struct PickHit {
+    int          item = -1;
+    unsigned int owner = 0;
+    float        distance = 0.0f;
+};
+
+// meshes placed in the world, each under its own model matrix and tagged with an owner id, kept in a BVH of their
+// world space boxes. adding a mesh rebuilds the tree on the next query, moving one only refits it.
+// the meshes must stay where they are in memory while they are in the tree.
+class SceneTree
+{
+public:
+    unsigned int Add(Mesh *mesh, const glm::mat4 &transform, unsigned int owner)
+    {
+        Item item;
+        item.mesh = mesh;
+        item.owner = owner;
+        item.transform = transform;
+        item.inverseTransform = glm::inverse(transform);
+        items.push_back(item);
+        dirty = true;
+        return (unsigned int) items.size() - 1;
+    }
+
+    void Move(unsigned int index, const glm::mat4 &transform)
+    {
+        Item &item = items[index];
+        item.transform = transform;
+        item.inverseTransform = glm::inverse(transform);
+        if (!dirty)
+            tree.Refit(index, AABB::Transformed(item.mesh->bounds, transform));
+    }
+
+    // calls visit(item) for every mesh whose box is at least partly inside the frustum
+    template <typename F>
+    void Query(const Frustum &frustum, F visit)
+    {
+        update();
+        tree.Query(frustum, visit);
+    }
+
+    // closest triangle along the ray within maxDistance, boxes first, then the triangles of the meshes they contain.
+    // the ray is taken into each mesh's model space, so distances stay in world units of the ray's direction.
+    PickHit Pick(const Ray &ray, float maxDistance)
+    {
+        update();
+        PickHit hit;
+        float distance = maxDistance;
+        hit.item = tree.Raycast(ray, distance, [&](unsigned int index, const Ray &, float &closest) {
+            Item &item = items[index];
+            return item.mesh->Triangles().Raycast(ray.Transformed(item.inverseTransform), closest) >= 0;
+        });
+        if (hit.item >= 0)
+        {
+            hit.owner = items[hit.item].owner;
+            hit.distance = distance;
+        }
+        return hit;
+    }
+
+    Mesh *MeshOf(unsigned int index) const { return items[index].mesh; }
+    unsigned int Owner(unsigned int index) const { return items[index].owner; }
+    const glm::mat4 &Transform(unsigned int index) const { return items[index].transform; }
+    unsigned int Size() const { return (unsigned int) items.size(); }
+
+private:
+    struct Item {
+        Mesh        *mesh;
+        unsigned int owner;
+        glm::mat4    transform;
+        glm::mat4    inverseTransform;
+    };
+    vector<Item> items;
+    BVH          tree;
+    bool         dirty = false;
+
+    void update()
+    {
+        if (!dirty)
+            return;
+        vector<AABB> boxes(items.size());
+        for (size_t index = 0; index < items.size(); index++)
+            boxes[index] = AABB::Transformed(items[index].mesh->bounds, items[index].transform);
+        tree.Build(boxes, 2);
+        dirty = false;
+    }
+};
+
+#endif
@@ -8,172 +8,385 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <initializer_list>
+#include <set>
+#include <vector>
 #include <common.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/trace.h>
+#include <learnopengl/uniform_table.h>
+#include <learnopengl/vertex_format.h>
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
-    // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
-    {
-        std::string vertexPathString(vertexPath);
-        std::string fragmentPathString(fragmentPath);
-        appendShaderFolderIfNotPresent(vertexPathString);
-        appendShaderFolderIfNotPresent(fragmentPathString);
-        vertexPath = vertexPathString.c_str();
-        fragmentPath= fragmentPathString.c_str();
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::string geometryCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        std::ifstream gShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
+    // see nextRevision()
+    unsigned int revision;
+    // constructor generates the shader on the fly; defines are "#define NAME value" lines for every stage. defines
+    // comes third as in shader_m.h, so Shader(vs, fs, defines) means the same whichever of the two was included
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string &defines = "", const char* geometryPath = nullptr)
+    {
+        TraceScope trace("Shader", vertexPath);
+        vertexFile = vertexPath;
+        fragmentFile = fragmentPath;
+        appendShaderFolderIfNotPresent(vertexFile);
+        appendShaderFolderIfNotPresent(fragmentFile);
+        // if geometry shader path is present, also load a geometry shader
+        if(geometryPath != nullptr)
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();		
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();			
-            // if geometry shader path is present, also load a geometry shader
-            if(geometryPath != nullptr)
-            {
-                std::string geometryPathString(geometryPath);
-                appendShaderFolderIfNotPresent(geometryPathString);
-                geometryPath = geometryPathString.c_str();
-                gShaderFile.open(geometryPath);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
+            geometryFile = geometryPath;
+            appendShaderFolderIfNotPresent(geometryFile);
         }
-        catch (std::ifstream::failure& e)
+        // every program is compiled against the vertex layout meshes upload
+        this->defines = VertexFormatDefines() + defines;
+        auto setupStart = std::chrono::steady_clock::now();
+        initial = submit();
+        ID = initial.program;
+        revision = nextRevision();
+        pending = true;
+        setupMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+    }
+    // true when using the program will not wait for the driver. without GL_KHR_parallel_shader_compile there is no
+    // way to ask, then it is always true and the first use waits
+    // ------------------------------------------------------------------------
+    bool ready() const
+    {
+        return !pending || complete(initial);
+    }
+    // finishes a batch of submitted programs in the order the driver completes them, so one slow program does not
+    // hold up the checks of the others
+    // ------------------------------------------------------------------------
+    static void finishAll(std::initializer_list<const Shader*> shaders)
+    {
+        std::vector<const Shader*> waiting(shaders);
+        while (!waiting.empty())
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+            size_t next = 0;
+            for (size_t i = 0; i < waiting.size(); i++)
+                if (waiting[i]->ready())
+                {
+                    next = i;
+                    break;
+                }
+            // none is done yet: wait for the oldest
+            waiting[next]->finish();
+            waiting.erase(waiting.begin() + next);
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if(geometryPath != nullptr)
+    }
+    // the vertex shader file, names the program in logs
+    // ------------------------------------------------------------------------
+    const std::string &path() const
+    {
+        return vertexFile;
+    }
+    // every file the program was built from, includes too
+    // ------------------------------------------------------------------------
+    const std::set<std::string> &sourceFiles() const
+    {
+        return files;
+    }
+    // rebuilds the program from its files after they changed. only submits the compile, pollReload() swaps the new
+    // program in once the driver has it; a newer reload replaces one still compiling
+    // ------------------------------------------------------------------------
+    void reload()
+    {
+        TraceScope trace("Shader::reload", vertexFile);
+        discard(reloading);
+        reloading = submit();
+    }
+    // true when a reloaded program replaced ID, then every uniform handle of the old one is stale. a program that
+    // does not compile or link is dropped, the old one stays and reloadError() tells why
+    // ------------------------------------------------------------------------
+    bool pollReload()
+    {
+        if (reloading.program == 0 || !complete(reloading))
+            return false;
+        finish();
+        std::string log;
+        if (!check(reloading, &log))
         {
-            const char * gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
+            discard(reloading);
+            reloadLog = log;
+            return false;
         }
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if(geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessery
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if(geometryPath != nullptr)
-            glDeleteShader(geometry);
-
+        GLState::Get().ForgetProgram(ID);
+        glDeleteProgram(ID);
+        ID = reloading.program;
+        reloading = Build();
+        revision = nextRevision();
+        uniforms.Reflect(ID);
+        reloadLog.clear();
+        return true;
+    }
+    // compile and link log of the last reload that failed, empty once one succeeds
+    // ------------------------------------------------------------------------
+    const std::string &reloadError() const
+    {
+        return reloadLog;
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() 
     { 
-        glUseProgram(ID); 
+        finish();
+        GLState::Get().UseProgram(ID);
+    }
+    // resolves a uniform once, the handle can be passed to the set functions every frame
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(const std::string &name) const
+    {
+        finish();
+        return uniforms.Find(name);
+    }
+    // attaches a uniform block to a binding point, programs without the block are left alone
+    // ------------------------------------------------------------------------
+    void bindUniformBlock(const std::string &name, unsigned int binding) const
+    {
+        finish();
+        unsigned int index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
-    {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    {
+        setBool(uniform(name), value);
+    }
+    void setBool(UniformHandle uniform, bool value) const
+    {
+        glUniform1i(uniform.location, (int)value); 
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
-    { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setInt(uniform(name), value);
+    }
+    void setInt(UniformHandle uniform, int value) const
+    {
+        glUniform1i(uniform.location, value); 
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
-    { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setFloat(uniform(name), value);
+    }
+    void setFloat(UniformHandle uniform, float value) const
+    {
+        glUniform1f(uniform.location, value); 
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
-    { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec2(uniform(name), value);
+    }
+    void setVec2(UniformHandle uniform, const glm::vec2 &value) const
+    {
+        glUniform2fv(uniform.location, 1, &value[0]); 
     }
     void setVec2(const std::string &name, float x, float y) const
-    { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+    {
+        setVec2(uniform(name), x, y);
+    }
+    void setVec2(UniformHandle uniform, float x, float y) const
+    {
+        glUniform2f(uniform.location, x, y); 
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
-    { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec3(uniform(name), value);
+    }
+    void setVec3(UniformHandle uniform, const glm::vec3 &value) const
+    {
+        glUniform3fv(uniform.location, 1, &value[0]); 
     }
     void setVec3(const std::string &name, float x, float y, float z) const
-    { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    {
+        setVec3(uniform(name), x, y, z);
+    }
+    void setVec3(UniformHandle uniform, float x, float y, float z) const
+    {
+        glUniform3f(uniform.location, x, y, z); 
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
-    { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec4(uniform(name), value);
     }
-    void setVec4(const std::string &name, float x, float y, float z, float w) 
-    { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    void setVec4(UniformHandle uniform, const glm::vec4 &value) const
+    {
+        glUniform4fv(uniform.location, 1, &value[0]); 
+    }
+    void setVec4(const std::string &name, float x, float y, float z, float w)
+    {
+        setVec4(uniform(name), x, y, z, w);
+    }
+    void setVec4(UniformHandle uniform, float x, float y, float z, float w)
+    {
+        glUniform4f(uniform.location, x, y, z, w); 
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(uniform(name), mat);
+    }
+    void setMat2(UniformHandle uniform, const glm::mat2 &mat) const
+    {
+        glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(uniform(name), mat);
+    }
+    void setMat3(UniformHandle uniform, const glm::mat3 &mat) const
+    {
+        glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(uniform(name), mat);
+    }
+    void setMat4(UniformHandle uniform, const glm::mat4 &mat) const
+    {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
-    // utility function for checking shader compilation/linking errors.
+    struct Stage {
+        unsigned int shader;
+        const char  *type;
+    };
+
+    // a program as submitted to the driver, its compile and link maybe still running
+    struct Build {
+        unsigned int       program = 0;
+        uint64_t           key = 0;
+        bool               fromCache = false;
+        std::vector<Stage> stages;
+    };
+
+    std::string                vertexFile, fragmentFile, geometryFile, defines;
+    std::set<std::string>      files;
+    // the constructor's build is checked by finish() on first use, hence mutable
+    mutable Build              initial;
+    mutable bool               pending = false;
+    mutable double             setupMilliseconds = 0.0;
+    mutable UniformTable       uniforms;
+    Build                      reloading;
+    std::string                reloadLog;
+
+    // changes whenever ID gets a new program and is unique across all shaders, unlike program names GL may reuse
+    static unsigned int nextRevision()
+    {
+        static unsigned int revisions = 0;
+        return ++revisions;
+    }
+
+    // 1. retrieve the source code from the files, includes resolved and the defines added
+    // 2. reuse the program linked on an earlier run while the sources and the driver are the same
+    // 3. otherwise submit the compiles and the link without waiting for them, the status is only asked for on first
+    // use, so the driver works on this program while the next ones are submitted and the models load
+    Build submit()
+    {
+        files.clear();
+        std::string vertexCode = readShaderSource(vertexFile, defines, &files);
+        std::string fragmentCode = readShaderSource(fragmentFile, defines, &files);
+        std::string geometryCode;
+        if(!geometryFile.empty())
+            geometryCode = readShaderSource(geometryFile, defines, &files);
+        Build build;
+        build.key = ProgramCache::Key({vertexCode, fragmentCode, geometryCode}, defines);
+        build.program = glCreateProgram();
+        build.fromCache = ProgramCache::Load(build.key, build.program);
+        if (!build.fromCache)
+        {
+            // a rejected binary may leave the program unusable, start over with a fresh one
+            glDeleteProgram(build.program);
+            build.program = glCreateProgram();
+            submitStage(build, GL_VERTEX_SHADER, vertexCode, "VERTEX");
+            submitStage(build, GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
+            if(!geometryCode.empty())
+                submitStage(build, GL_GEOMETRY_SHADER, geometryCode, "GEOMETRY");
+            ProgramCache::PrepareLink(build.program);
+            glLinkProgram(build.program);
+        }
+        return build;
+    }
+
+    static void submitStage(Build &build, GLenum type, const std::string &code, const char *typeName)
+    {
+        const char *source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        glAttachShader(build.program, shader);
+        build.stages.push_back({shader, typeName});
+    }
+
+    // true when checking the build will not wait for the driver, see ready()
+    static bool complete(const Build &build)
+    {
+        if (build.fromCache || !GLExtensions::Get().parallelShaderCompile)
+            return true;
+        GLint done = GL_FALSE;
+        glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    // waits for the build, reports its errors and stores the binary of a program that linked
+    static bool check(Build &build, std::string *log)
+    {
+        if (build.fromCache)
+            return true;
+        bool compiled = true;
+        for (const Stage &stage : build.stages)
+        {
+            compiled = checkCompileErrors(stage.shader, stage.type, log) && compiled;
+            // delete the shaders as they're linked into our program now and no longer necessery
+            glDeleteShader(stage.shader);
+        }
+        build.stages.clear();
+        bool linked = checkCompileErrors(build.program, "PROGRAM", log);
+        if (compiled && linked)
+            ProgramCache::Store(build.key, build.program);
+        return compiled && linked;
+    }
+
+    static void discard(Build &build)
+    {
+        for (const Stage &stage : build.stages)
+            glDeleteShader(stage.shader);
+        if (build.program != 0)
+            glDeleteProgram(build.program);
+        build = Build();
+    }
+
+    // waits for the compile and link submitted by the constructor, reports their errors, stores the binary and
+    // looks up every uniform location once, the set functions never ask GL again. runs once per program
+    // ------------------------------------------------------------------------
+    void finish() const
+    {
+        if (!pending)
+            return;
+        TraceScope trace("Shader::finish", vertexFile);
+        auto finishStart = std::chrono::steady_clock::now();
+        check(initial, nullptr);
+        uniforms.Reflect(ID);
+        pending = false;
+        setupMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finishStart).count();
+        ProgramCache::RecordLoad(vertexFile, initial.fromCache, setupMilliseconds);
+    }
+
+    // utility function for checking shader compilation/linking errors, true when there were none.
+    // the errors also go to log when it is given
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    static bool checkCompileErrors(GLuint shader, std::string type, std::string *log = nullptr)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -184,6 +397,8 @@ private:
             {
                 glGetShaderInfoLog(shader, 1024, NULL, infoLog);
                 std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                if(log)
+                    *log += type + ": " + infoLog;
             }
         }
         else
@@ -193,8 +408,11 @@ private:
             {
                 glGetProgramInfoLog(shader, 1024, NULL, infoLog);
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                if(log)
+                    *log += type + ": " + infoLog;
             }
         }
+        return success;
     }
 };
 #endif
@@ -0,0 +1,124 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <learnopengl/shader_m.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+// material keywords of a shader variant, the bits of a variant key below the light count
+enum ShaderFeature {
+    FEATURE_SPECULAR_MAP = 1 << 0,
+    FEATURE_NORMAL_MAP   = 1 << 1,
+    FEATURE_ALPHA_TEST   = 1 << 2,
+    FEATURE_SPOT_LIGHT   = 1 << 3,
+    // the model matrix from the per draw instance attribute of a multi-draw batch instead of the uniform
+    FEATURE_INSTANCED_TRANSFORM = 1 << 4
+};
+
+// the point light count sits above the feature bits of a key
+#define SHADER_VARIANT_LIGHT_SHIFT 8
+
+// one vertex/fragment source pair compiled once for every combination of keywords it is asked for, so each draw
+// runs the cheapest program that covers its material and the active lights. every combination turns into the
+// POINT_LIGHTS, SPOT_LIGHT, HAS_SPECULAR_MAP, HAS_NORMAL_MAP, ALPHA_TEST and INSTANCED_TRANSFORM defines, which
+// the sources read.
+// variants are submitted on first request and kept for the life of the set; the program cache keeps them on disk.
+class ShaderVariants
+{
+public:
+    struct Variant {
+        unsigned int       key;
+        unique_ptr<Shader> shader;
+        // the per-draw model matrix, every variant without FEATURE_INSTANCED_TRANSFORM has one
+        UniformHandle      model;
+        bool               ready = false;
+    };
+
+    ShaderVariants(const string &vertexPath, const string &fragmentPath)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath) {}
+
+    static unsigned int Key(unsigned int features, unsigned int pointLights)
+    {
+        return features | pointLights << SHADER_VARIANT_LIGHT_SHIFT;
+    }
+
+    // the defines a key compiles with
+    static string Defines(unsigned int key)
+    {
+        string defines;
+        defines += "#define POINT_LIGHTS " + to_string(key >> SHADER_VARIANT_LIGHT_SHIFT) + "\n";
+        defines += string("#define SPOT_LIGHT ") + (key & FEATURE_SPOT_LIGHT ? "1" : "0") + "\n";
+        defines += string("#define HAS_SPECULAR_MAP ") + (key & FEATURE_SPECULAR_MAP ? "1" : "0") + "\n";
+        defines += string("#define HAS_NORMAL_MAP ") + (key & FEATURE_NORMAL_MAP ? "1" : "0") + "\n";
+        defines += string("#define ALPHA_TEST ") + (key & FEATURE_ALPHA_TEST ? "1" : "0") + "\n";
+        defines += string("#define INSTANCED_TRANSFORM ") + (key & FEATURE_INSTANCED_TRANSFORM ? "1" : "0") + "\n";
+        return defines;
+    }
+
+    // runs once on every variant before its first use, for the uniforms that never change afterwards
+    void OnFirstUse(function<void(Shader &)> setup)
+    {
+        this->setup = setup;
+    }
+
+    // submits the compile of a variant that is going to be needed soon, without waiting for it
+    void Prepare(unsigned int key)
+    {
+        find(key);
+    }
+
+    // the variant for a key ready to draw with; compiled now unless Prepare() submitted it earlier
+    const Variant &Get(unsigned int key)
+    {
+        Variant &variant = find(key);
+        if (!variant.ready)
+        {
+            if (setup)
+                setup(*variant.shader);
+            variant.model = variant.shader->uniform("model");
+            variant.ready = true;
+        }
+        return variant;
+    }
+
+    // swaps in hot reloaded programs that are ready, their setup runs again before the next draw
+    void PollReloads()
+    {
+        for (const unique_ptr<Variant> &variant : variants)
+            if (variant->shader->pollReload())
+                variant->ready = false;
+    }
+
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (const unique_ptr<Variant> &variant : variants)
+            f(*variant->shader);
+    }
+
+    size_t Size() const { return variants.size(); }
+
+private:
+    string                      vertexPath, fragmentPath;
+    function<void(Shader &)>    setup;
+    // a handful of variants at most, a linear search beats hashing
+    vector<unique_ptr<Variant>> variants;
+
+    Variant &find(unsigned int key)
+    {
+        for (const unique_ptr<Variant> &variant : variants)
+            if (variant->key == key)
+                return *variant;
+        unique_ptr<Variant> variant(new Variant());
+        variant->key = key;
+        variant->shader.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), Defines(key)));
+        variants.push_back(move(variant));
+        return *variants.back();
+    }
+};
+
+#endif
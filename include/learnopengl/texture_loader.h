@@ -0,0 +1,288 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <learnopengl/gl_state.h>
+#include <learnopengl/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// splits texture loading into a decode stage running on a pool of worker threads and an upload stage
+// that runs on the thread owning the GL context. ids are handed out right away, storage arrives on Upload().
+class TextureLoader
+{
+public:
+    typedef chrono::steady_clock Clock;
+
+    static TextureLoader &Get()
+    {
+        static TextureLoader loader;
+        return loader;
+    }
+
+    // queues a 2D texture; with clampAlpha textures that have an alpha channel use GL_CLAMP_TO_EDGE instead of GL_REPEAT
+    unsigned int Load2D(const string &path, bool flipVertically = false, bool clampAlpha = false)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        submit(textureID, GL_TEXTURE_2D, path, flipVertically, clampAlpha);
+        return textureID;
+    }
+
+    // queues the six faces of a cubemap, in +X, -X, +Y, -Y, +Z, -Z order
+    unsigned int LoadCubemap(const vector<string> &faces)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        GLState::Get().BindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        for (unsigned int i = 0; i < faces.size(); i++)
+            submit(textureID, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, faces[i], false, false);
+        return textureID;
+    }
+
+    // uploads at most maxImages decoded images, must be called from the GL thread. returns how many were uploaded.
+    unsigned int Upload(unsigned int maxImages = ~0u)
+    {
+        unsigned int uploaded = 0;
+        while (uploaded < maxImages)
+        {
+            Job job;
+            {
+                lock_guard<mutex> lock(queueMutex);
+                if (decoded.empty())
+                    break;
+                job = decoded.front();
+                decoded.pop_front();
+            }
+            upload(job);
+            uploaded++;
+        }
+        return uploaded;
+    }
+
+    // blocks until every queued texture is decoded and uploaded
+    void Finish()
+    {
+        for (;;)
+        {
+            Upload();
+            unique_lock<mutex> lock(queueMutex);
+            if (inFlight == 0 && decoded.empty())
+                return;
+            decodedSignal.wait(lock, [this] { return !decoded.empty() || inFlight == 0; });
+        }
+    }
+
+    // true while the texture has no storage yet; GL thread only
+    bool Pending(unsigned int id) const
+    {
+        return waiting.count(id) != 0;
+    }
+
+    bool Idle()
+    {
+        lock_guard<mutex> lock(queueMutex);
+        return inFlight == 0 && decoded.empty();
+    }
+
+    // per texture decode/upload timings of everything uploaded so far
+    void PrintReport()
+    {
+        double decodeMs = 0.0, uploadMs = 0.0;
+        Clock::time_point first = Clock::time_point::max(), last = Clock::time_point::min();
+        for (const Job &job : finished)
+        {
+            double decode = milliseconds(job.decodeStart, job.decodeEnd);
+            double upload = milliseconds(job.uploadStart, job.uploadEnd);
+            cout << "TEXTURE_LOADER:: decode " << decode << " ms, upload " << upload << " ms, "
+                 << job.width << "x" << job.height << "x" << job.components << "  " << job.path << endl;
+            decodeMs += decode;
+            uploadMs += upload;
+            first = min(first, job.submitted);
+            last = max(last, job.uploadEnd);
+        }
+        if (finished.empty())
+            return;
+        cout << "TEXTURE_LOADER:: " << finished.size() << " images on " << workers.size() << " workers: "
+             << decodeMs << " ms decoding, " << uploadMs << " ms uploading, "
+             << milliseconds(first, last) << " ms wall time" << endl;
+    }
+
+    ~TextureLoader()
+    {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        pendingSignal.notify_all();
+        for (thread &worker : workers)
+            worker.join();
+        for (Job &job : decoded)
+            stbi_image_free(job.pixels);
+    }
+
+private:
+    struct Job {
+        unsigned int   id = 0;
+        GLenum         target = GL_TEXTURE_2D;
+        string         path;
+        bool           flipVertically = false;
+        bool           clampAlpha = false;
+        unsigned char *pixels = nullptr;
+        int            width = 0, height = 0, components = 0;
+        Clock::time_point submitted, decodeStart, decodeEnd, uploadStart, uploadEnd;
+    };
+
+    vector<thread>     workers;
+    deque<Job>         pending;
+    deque<Job>         decoded;
+    vector<Job>        finished;
+    unordered_map<unsigned int, unsigned int> waiting; // images still to upload per texture id, only touched by the GL thread
+    unsigned int       inFlight = 0;
+    bool               stopping = false;
+    mutex              queueMutex;
+    condition_variable pendingSignal;
+    condition_variable decodedSignal;
+
+    TextureLoader()
+    {
+        // leave one core to the GL thread, which keeps parsing models while the workers decode
+        unsigned int cores = thread::hardware_concurrency();
+        unsigned int count = cores > 1 ? cores - 1 : 1;
+        for (unsigned int i = 0; i < count; i++)
+            workers.emplace_back(&TextureLoader::work, this);
+    }
+
+    static double milliseconds(Clock::time_point from, Clock::time_point to)
+    {
+        return chrono::duration<double, milli>(to - from).count();
+    }
+
+    void submit(unsigned int id, GLenum target, const string &path, bool flipVertically, bool clampAlpha)
+    {
+        Job job;
+        job.id = id;
+        job.target = target;
+        job.path = path;
+        job.flipVertically = flipVertically;
+        job.clampAlpha = clampAlpha;
+        job.submitted = Clock::now();
+        waiting[id]++;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            pending.push_back(job);
+            inFlight++;
+        }
+        pendingSignal.notify_one();
+    }
+
+    void work()
+    {
+        Trace::Get().SetThreadName("texture worker");
+        for (;;)
+        {
+            Job job;
+            {
+                unique_lock<mutex> lock(queueMutex);
+                pendingSignal.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (stopping)
+                    return;
+                job = pending.front();
+                pending.pop_front();
+            }
+            uint64_t traceBegin = Trace::Get().Now();
+            job.decodeStart = Clock::now();
+            // stbi_set_flip_vertically_on_load is global state, so flipping is done here per image instead. stb_image
+            // is built without failure strings (libs/stb_image.cpp), the only other global it would write
+            job.pixels = stbi_load(job.path.c_str(), &job.width, &job.height, &job.components, 0);
+            if (job.pixels && job.flipVertically)
+                flipRows(job);
+            job.decodeEnd = Clock::now();
+            Trace::Get().Record("TextureLoader::decode", traceBegin, Trace::Get().Now(), job.path.c_str());
+            {
+                lock_guard<mutex> lock(queueMutex);
+                decoded.push_back(job);
+                inFlight--;
+            }
+            decodedSignal.notify_all();
+        }
+    }
+
+    static void flipRows(Job &job)
+    {
+        size_t stride = (size_t) job.width * job.components;
+        vector<unsigned char> row(stride);
+        for (int top = 0, bottom = job.height - 1; top < bottom; top++, bottom--)
+        {
+            unsigned char *a = job.pixels + top * stride;
+            unsigned char *b = job.pixels + bottom * stride;
+            memcpy(row.data(), a, stride);
+            memcpy(a, b, stride);
+            memcpy(b, row.data(), stride);
+        }
+    }
+
+    void upload(Job &job)
+    {
+        TraceScope trace("TextureLoader::upload", job.path);
+        job.uploadStart = Clock::now();
+        if (job.pixels)
+        {
+            GLenum format = GL_RGB;
+            if (job.components == 1)
+                format = GL_RED;
+            else if (job.components == 3)
+                format = GL_RGB;
+            else if (job.components == 4)
+                format = GL_RGBA;
+
+            if (job.target == GL_TEXTURE_2D)
+            {
+                GLState::Get().BindTexture(GL_TEXTURE_2D, job.id);
+                glTexImage2D(GL_TEXTURE_2D, 0, format, job.width, job.height, 0, format, GL_UNSIGNED_BYTE, job.pixels);
+                glGenerateMipmap(GL_TEXTURE_2D);
+
+                GLint wrap = job.clampAlpha && format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT; // use GL_CLAMP_TO_EDGE to prevent semi-transparent borders
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            }
+            else
+            {
+                GLState::Get().BindTexture(GL_TEXTURE_CUBE_MAP, job.id);
+                glTexImage2D(job.target, 0, format, job.width, job.height, 0, format, GL_UNSIGNED_BYTE, job.pixels);
+            }
+            stbi_image_free(job.pixels);
+            job.pixels = nullptr;
+        }
+        else
+        {
+            std::cout << "Texture failed to load at path: " << job.path << std::endl;
+        }
+        job.uploadEnd = Clock::now();
+        finished.push_back(job);
+        if (--waiting[job.id] == 0)
+            waiting.erase(job.id);
+    }
+};
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef TEXTURE_REGISTRY_H
+#define TEXTURE_REGISTRY_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <learnopengl/gl_state.h>
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/texture_loader.h>
+
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// an image file as TextureRegistry::Inspect() read it: the hash of its bytes and its decoded size
+struct TextureFileInfo {
+    bool     valid = false;
+    uint64_t contentHash = 0;
+    size_t   cpuBytes = 0;
+};
+
+// process wide, ref-counted set of loaded textures. a texture is found by its canonical absolute path, size and
+// mtime in O(1), and, when the caller inspected the file beforehand, a file that was already loaded under another
+// path is found by its content hash; every image is then decoded and uploaded once no matter how many models or
+// loaders ask for it. the GL thread never reads a whole image here, hashing is left to Inspect() on the caller's
+// worker thread (the model importer does it for every material texture). GL thread only, except Inspect().
+class TextureRegistry
+{
+public:
+    static TextureRegistry &Get()
+    {
+        static TextureRegistry registry;
+        return registry;
+    }
+
+    // hashes a whole image file and reads its dimensions; touches no registry state, so any thread may call it
+    static TextureFileInfo Inspect(const string &path)
+    {
+        TextureFileInfo info;
+        MappedFile file(path);
+        if (!file.valid())
+            return info;
+        info.valid = true;
+        info.contentHash = hashBytes(file.data, file.size);
+        int width = 0, height = 0, components = 0;
+        if (stbi_info_from_memory(file.data, (int) file.size, &width, &height, &components))
+            info.cpuBytes = (size_t) width * height * components;
+        return info;
+    }
+
+    // looked up by path only, a copy of a loaded file under another path is loaded again
+    unsigned int Acquire2D(const string &path, bool flipVertically = false, bool clampAlpha = false)
+    {
+        return Acquire2D(path, TextureFileInfo(), flipVertically, clampAlpha);
+    }
+
+    // file is what Inspect() returned for path, it makes copies under other paths share the texture
+    unsigned int Acquire2D(const string &path, const TextureFileInfo &file, bool flipVertically = false, bool clampAlpha = false)
+    {
+        string variant = string(flipVertically ? "|flip" : "") + (clampAlpha ? "|clamp" : "");
+        string canonical = canonicalPath(path);
+        string key = canonical + fileStamp(canonical) + variant;
+        unsigned int id;
+        if (acquireByPath(key, id))
+            return id;
+
+        Entry entry;
+        if (file.valid)
+        {
+            entry.contentHash = hashBytes(variant.data(), variant.size(), file.contentHash);
+            if (acquireByContent(entry.contentHash, key, id))
+                return id;
+            entry.cpuBytes = file.cpuBytes;
+        }
+        else
+        {
+            entry.cpuBytes = headerBytes(canonical);
+        }
+        entry.vramBytes = entry.cpuBytes * 4 / 3; // mipmap chain
+        entry.id = TextureLoader::Get().Load2D(canonical, flipVertically, clampAlpha);
+        return insert(entry, key, file.valid);
+    }
+
+    unsigned int AcquireCubemap(const vector<string> &faces)
+    {
+        vector<string> canonicalFaces;
+        string key = "cubemap";
+        for (const string &face : faces)
+        {
+            canonicalFaces.push_back(canonicalPath(face));
+            key += "|" + canonicalFaces.back() + fileStamp(canonicalFaces.back());
+        }
+        unsigned int id;
+        if (acquireByPath(key, id))
+            return id;
+
+        // cubemaps are shared by their face paths only
+        Entry entry;
+        for (const string &face : canonicalFaces)
+            entry.cpuBytes += headerBytes(face);
+        entry.vramBytes = entry.cpuBytes;
+        entry.id = TextureLoader::Get().LoadCubemap(canonicalFaces);
+        return insert(entry, key, false);
+    }
+
+    // drops one reference, the GL texture is deleted with the last one
+    void Release(unsigned int id)
+    {
+        auto found = entries.find(id);
+        if (found == entries.end() || --found->second.refs > 0)
+            return;
+        for (const string &key : found->second.keys)
+            byPath.erase(key);
+        auto content = byContent.find(found->second.contentHash);
+        if (content != byContent.end() && content->second == id)
+            byContent.erase(content);
+        GLState::Get().ForgetTexture(id);
+        glDeleteTextures(1, &id);
+        entries.erase(found);
+    }
+
+    void PrintReport() const
+    {
+        size_t cpuSaved = 0, vramSaved = 0, cpuUsed = 0, vramUsed = 0;
+        unsigned int pathHits = 0, contentHits = 0;
+        for (const auto &item : entries)
+        {
+            const Entry &entry = item.second;
+            cpuSaved += (entry.pathHits + entry.contentHits) * entry.cpuBytes;
+            vramSaved += (entry.pathHits + entry.contentHits) * entry.vramBytes;
+            cpuUsed += entry.cpuBytes;
+            vramUsed += entry.vramBytes;
+            pathHits += entry.pathHits;
+            contentHits += entry.contentHits;
+        }
+        cout << "TEXTURE_REGISTRY:: " << entries.size() << " unique textures (" << cpuUsed / 1024 << " KB decoded, "
+             << vramUsed / 1024 << " KB VRAM), " << pathHits << " path hits, " << contentHits << " content hits, saved "
+             << cpuSaved / 1024 << " KB decoding and " << vramSaved / 1024 << " KB VRAM" << endl;
+    }
+
+private:
+    struct Entry {
+        unsigned int   id = 0;
+        unsigned int   refs = 0;
+        unsigned int   pathHits = 0;
+        unsigned int   contentHits = 0;
+        uint64_t       contentHash = 0;
+        size_t         cpuBytes = 0;
+        size_t         vramBytes = 0;
+        vector<string> keys;
+    };
+
+    unordered_map<string, unsigned int>   byPath;
+    unordered_map<uint64_t, unsigned int> byContent;
+    unordered_map<unsigned int, Entry>    entries;
+
+    TextureRegistry() {}
+
+    static string canonicalPath(const string &path)
+    {
+        char resolved[PATH_MAX];
+        if (realpath(path.c_str(), resolved))
+            return resolved;
+        return path;
+    }
+
+    // "|size|mtime", so a file replaced on disk is loaded again instead of served from its old entry
+    static string fileStamp(const string &path)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return "";
+        return "|" + to_string((long long) info.st_size) + "|" + to_string((long long) info.st_mtime);
+    }
+
+    // decoded size from the image header alone
+    static size_t headerBytes(const string &path)
+    {
+        int width = 0, height = 0, components = 0;
+        if (!stbi_info(path.c_str(), &width, &height, &components))
+            return 0;
+        return (size_t) width * height * components;
+    }
+
+    bool acquireByPath(const string &key, unsigned int &id)
+    {
+        auto found = byPath.find(key);
+        if (found == byPath.end())
+            return false;
+        Entry &entry = entries[found->second];
+        entry.refs++;
+        entry.pathHits++;
+        id = entry.id;
+        return true;
+    }
+
+    // same bytes under a different path: remember the new path as another name of the same texture
+    bool acquireByContent(uint64_t contentHash, const string &key, unsigned int &id)
+    {
+        auto found = byContent.find(contentHash);
+        if (found == byContent.end())
+            return false;
+        Entry &entry = entries[found->second];
+        entry.refs++;
+        entry.contentHits++;
+        entry.keys.push_back(key);
+        byPath[key] = entry.id;
+        id = entry.id;
+        return true;
+    }
+
+    unsigned int insert(Entry &entry, const string &key, bool hashed)
+    {
+        entry.refs = 1;
+        entry.keys.push_back(key);
+        byPath[key] = entry.id;
+        if (hashed)
+            byContent[entry.contentHash] = entry.id;
+        entries[entry.id] = entry;
+        return entry.id;
+    }
+};
+
+#endif
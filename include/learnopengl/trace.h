@@ -0,0 +1,191 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+// events per chunk of a thread's buffer and chunks per thread; a thread that fills all of them drops new events
+#define TRACE_CHUNK_EVENTS 4096
+#define TRACE_MAX_CHUNKS 256
+// bytes of detail kept per event, longer details keep their end (the file name of a path)
+#define TRACE_DETAIL_SIZE 40
+
+// one timed span; name must be a string literal, detail is copied
+struct TraceEvent {
+    const char *name;
+    uint64_t    begin;
+    uint64_t    end;
+    char        detail[TRACE_DETAIL_SIZE];
+};
+
+// records begin/end spans of every thread and writes them as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// each thread appends to its own buffer without locking: the events go into chunks only that thread writes and are
+// published with a release store of the count, which Write() reads with acquire. only registering a new thread
+// takes the lock. times are nanoseconds since the first use of the trace.
+class Trace
+{
+public:
+    typedef chrono::steady_clock Clock;
+
+    static Trace &Get()
+    {
+        static Trace trace;
+        return trace;
+    }
+
+    uint64_t Now() const
+    {
+        return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    void Record(const char *name, uint64_t begin, uint64_t end, const char *detail = nullptr)
+    {
+        ThreadBuffer &buffer = current();
+        uint32_t index = buffer.count.load(memory_order_relaxed);
+        if (index >= TRACE_CHUNK_EVENTS * TRACE_MAX_CHUNKS)
+        {
+            buffer.dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        unique_ptr<TraceEvent[]> &chunk = buffer.chunks[index / TRACE_CHUNK_EVENTS];
+        if (!chunk)
+            chunk.reset(new TraceEvent[TRACE_CHUNK_EVENTS]);
+        TraceEvent &event = chunk[index % TRACE_CHUNK_EVENTS];
+        event.name = name;
+        event.begin = begin;
+        event.end = end;
+        event.detail[0] = '\0';
+        if (detail)
+        {
+            size_t length = strlen(detail);
+            const char *tail = length < TRACE_DETAIL_SIZE ? detail : detail + length - (TRACE_DETAIL_SIZE - 1);
+            strncpy(event.detail, tail, TRACE_DETAIL_SIZE - 1);
+            event.detail[TRACE_DETAIL_SIZE - 1] = '\0';
+        }
+        buffer.count.store(index + 1, memory_order_release);
+    }
+
+    // shown as the thread's name in the trace viewer
+    void SetThreadName(const string &name)
+    {
+        ThreadBuffer &buffer = current();
+        lock_guard<mutex> lock(threadsMutex);
+        buffer.name = name;
+    }
+
+    // writes everything recorded so far; may run while other threads keep recording
+    bool Write(const string &path)
+    {
+        ofstream out(path);
+        if (!out)
+        {
+            cout << "ERROR::TRACE::CANNOT_WRITE " << path << endl;
+            return false;
+        }
+        lock_guard<mutex> lock(threadsMutex);
+        // microseconds with nanosecond resolution, never in exponent notation
+        out << fixed << setprecision(3);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        size_t events = 0, dropped = 0;
+        for (const unique_ptr<ThreadBuffer> &buffer : threads)
+        {
+            out << (first ? "" : ",\n") << "{\"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+                << ", \"name\": \"thread_name\", \"args\": {\"name\": \"" << escape(buffer->name) << "\"}}";
+            first = false;
+            uint32_t count = buffer->count.load(memory_order_acquire);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const TraceEvent &event = buffer->chunks[i / TRACE_CHUNK_EVENTS][i % TRACE_CHUNK_EVENTS];
+                out << ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id << ", \"name\": \"" << escape(event.name)
+                    << "\", \"ts\": " << event.begin / 1000.0 << ", \"dur\": " << (event.end - event.begin) / 1000.0;
+                if (event.detail[0])
+                    out << ", \"args\": {\"detail\": \"" << escape(event.detail) << "\"}";
+                out << "}";
+            }
+            events += count;
+            dropped += buffer->dropped.load(memory_order_relaxed);
+        }
+        out << "\n]}\n";
+        cout << "TRACE:: " << events << " events of " << threads.size() << " threads written to " << path;
+        if (dropped > 0)
+            cout << ", " << dropped << " dropped after the buffers filled up";
+        cout << endl;
+        return true;
+    }
+
+private:
+    struct ThreadBuffer {
+        unsigned int             id = 0;
+        string                   name;
+        unique_ptr<TraceEvent[]> chunks[TRACE_MAX_CHUNKS];
+        atomic<uint32_t>         count{0};
+        atomic<uint32_t>         dropped{0};
+    };
+
+    Clock::time_point                start;
+    mutex                            threadsMutex;
+    vector<unique_ptr<ThreadBuffer>> threads;
+
+    Trace() : start(Clock::now()) {}
+
+    // buffers outlive their threads, the events of finished threads are still written
+    ThreadBuffer &current()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (!buffer)
+        {
+            lock_guard<mutex> lock(threadsMutex);
+            threads.emplace_back(new ThreadBuffer());
+            buffer = threads.back().get();
+            buffer->id = (unsigned int) threads.size();
+            buffer->name = "thread " + to_string(buffer->id);
+        }
+        return *buffer;
+    }
+
+    static string escape(const string &text)
+    {
+        string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+};
+
+// records the enclosing scope as one trace event
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name, const string &detail = string())
+        : name(name), detail(detail), begin(Trace::Get().Now()) {}
+
+    ~TraceScope()
+    {
+        Trace::Get().Record(name, begin, Trace::Get().Now(), detail.empty() ? nullptr : detail.c_str());
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    string      detail;
+    uint64_t    begin;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// binding points of the uniform blocks shared by all programs, see Shader::bindUniformBlock
+enum UniformBlockBinding {
+    FRAME_DATA_BINDING = 0,
+    LIGHT_DATA_BINDING = 1
+};
+
+#define NR_POINT_LIGHTS 2
+
+// std140 mirrors of the blocks declared in the shaders. every vec3 is followed by a float,
+// which is exactly how std140 packs them, so the C++ and GLSL layouts match without padding tricks.
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 viewPosition;
+};
+
+struct PointLightData {
+    glm::vec3 position;
+    float     constant;
+    glm::vec3 ambient;
+    float     linear;
+    glm::vec3 diffuse;
+    float     quadratic;
+    glm::vec3 specular;
+    float     padding;
+};
+
+struct SpotLightData {
+    glm::vec3 position;
+    float     constant;
+    glm::vec3 direction;
+    float     linear;
+    glm::vec3 ambient;
+    float     quadratic;
+    glm::vec3 diffuse;
+    float     cutOff;
+    glm::vec3 specular;
+    float     outerCutOff;
+};
+
+struct LightData {
+    PointLightData pointLights[NR_POINT_LIGHTS];
+    SpotLightData  spotLight;
+};
+
+static_assert(sizeof(FrameData) == 144, "FrameData does not match the std140 FrameData block");
+static_assert(sizeof(PointLightData) == 64 && sizeof(SpotLightData) == 80, "light structs do not match std140");
+
+// a uniform buffer bound to one binding point for its whole life, rewritten once per frame
+class UniformBuffer
+{
+public:
+    unsigned int ID = 0;
+
+    void Create(size_t size, unsigned int binding)
+    {
+        this->size = size;
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    template <typename T>
+    void Update(const T &data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        // orphan the old storage so a frame still reading it on the GPU never stalls this write
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void Delete()
+    {
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+    }
+
+private:
+    size_t size = 0;
+};
+
+#endif
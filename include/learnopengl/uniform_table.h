@@ -0,0 +1,69 @@
+#ifndef UNIFORM_TABLE_H
+#define UNIFORM_TABLE_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a uniform location resolved once; an invalid handle (-1) makes the set call a no-op, just like in GL
+struct UniformHandle {
+    int location = -1;
+
+    UniformHandle() {}
+    explicit UniformHandle(int location) : location(location) {}
+    bool valid() const { return location >= 0; }
+};
+
+// locations of all active uniforms of a program, reflected once right after linking
+class UniformTable
+{
+public:
+    void Reflect(unsigned int program)
+    {
+        locations.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> name(maxLength + 1);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            GLsizei length = 0;
+            glGetActiveUniform(program, i, (GLsizei) name.size(), &length, &size, &type, name.data());
+            std::string uniformName(name.data(), length);
+            int location = glGetUniformLocation(program, uniformName.c_str());
+            // members of uniform blocks are active too, but have no location of their own
+            if (location < 0)
+                continue;
+            locations[uniformName] = location;
+            // arrays are reported as "name[0]", make "name" and every "name[i]" resolvable as well
+            size_t bracket = uniformName.rfind("[0]");
+            if (bracket != std::string::npos && bracket + 3 == uniformName.size())
+            {
+                std::string base = uniformName.substr(0, bracket);
+                locations[base] = location;
+                for (GLint element = 1; element < size; element++)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    locations[elementName] = glGetUniformLocation(program, elementName.c_str());
+                }
+            }
+        }
+    }
+
+    UniformHandle Find(const std::string &name) const
+    {
+        auto found = locations.find(name);
+        return found == locations.end() ? UniformHandle() : UniformHandle(found->second);
+    }
+
+    size_t Size() const { return locations.size(); }
+
+private:
+    std::unordered_map<std::string, int> locations;
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+using namespace std;
+
+// how meshes lay out their vertices on the GPU. both are compile time switches, every Shader gets them as defines
+// so the vertex shaders (include/vertex_input.glsl) decode the same layout Mesh uploads.
+// 1: positions as 16-bit fractions of the mesh bounds, scaled back by the vertex shader; 0: plain floats
+#define VERTEX_QUANTIZED_POSITIONS 0
+// 1: the normal in two 16-bit octahedral coordinates, decoded by the vertex shader; 0: 10:10:10:2, decoded by the
+// vertex fetch
+#define VERTEX_OCTAHEDRAL_NORMALS 0
+
+// first of the four attribute locations taking the per instance model matrix, see SetupInstanceAttributes
+#define INSTANCE_MODEL_ATTRIBUTE 5
+
+// 20 or 24 bytes against the 56 of the old float Vertex with a bitangent
+struct PackedVertex {
+#if VERTEX_QUANTIZED_POSITIONS
+    // x, y, z and padding that keeps the rest 4-byte aligned
+    uint16_t position[4];
+#else
+    float    position[3];
+#endif
+    uint32_t normal;
+    // 10:10:10:2, the 2-bit w is the sign of the bitangent
+    uint32_t tangent;
+    // half floats
+    uint16_t texCoords[2];
+};
+
+// "#define" lines telling the shaders about the layout above
+inline string VertexFormatDefines()
+{
+    return "#define VERTEX_QUANTIZED_POSITIONS " + to_string(VERTEX_QUANTIZED_POSITIONS) + "\n"
+           "#define VERTEX_OCTAHEDRAL_NORMALS " + to_string(VERTEX_OCTAHEDRAL_NORMALS) + "\n";
+}
+
+// IEEE half float, rounded to nearest; out of range values become infinity
+inline uint16_t PackHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    int exponent = (int) ((bits >> 23) & 0xFF);
+    if (exponent == 0xFF)
+        return (uint16_t) (sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    exponent += 15 - 127;
+    if (exponent >= 31)
+        return (uint16_t) (sign | 0x7C00);
+    if (exponent <= 0)
+    {
+        // denormal half, or zero when even that is too small
+        if (exponent < -10)
+            return (uint16_t) sign;
+        mantissa |= 0x800000;
+        unsigned int shift = (unsigned int) (14 - exponent);
+        return (uint16_t) (sign | ((mantissa + (1u << (shift - 1))) >> shift));
+    }
+    // a carry out of the mantissa rounds up into the exponent, which is what it should do
+    return (uint16_t) ((sign | (uint32_t) exponent << 10 | mantissa >> 13) + ((mantissa >> 12) & 1));
+}
+
+// x, y and z in [-1, 1] as 10-bit signed normalized, w as -1 or 1 in the top two bits (GL_INT_2_10_10_10_REV)
+inline uint32_t PackSnorm10x3(const glm::vec3 &v, float w = 1.0f)
+{
+    uint32_t packed = w < 0.0f ? 3u << 30 : 1u << 30;
+    for (int i = 0; i < 3; i++)
+    {
+        int component = (int) lround(glm::clamp(v[i], -1.0f, 1.0f) * 511.0f);
+        packed |= ((uint32_t) component & 0x3FF) << (10 * i);
+    }
+    return packed;
+}
+
+// unit vector folded onto the octahedron and its lower half unfolded into the square, two 16-bit signed
+// normalized coordinates, x in the low half
+inline uint32_t PackOctahedral(const glm::vec3 &n)
+{
+    float sum = fabs(n.x) + fabs(n.y) + fabs(n.z);
+    float x = sum > 0.0f ? n.x / sum : 0.0f, y = sum > 0.0f ? n.y / sum : 0.0f;
+    if (n.z < 0.0f)
+    {
+        float folded = (1.0f - fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = folded;
+    }
+    uint32_t packedX = (uint16_t) (int16_t) lround(glm::clamp(x, -1.0f, 1.0f) * 32767.0f);
+    uint32_t packedY = (uint16_t) (int16_t) lround(glm::clamp(y, -1.0f, 1.0f) * 32767.0f);
+    return packedX | packedY << 16;
+}
+
+// the attribute pointers of the layout for the VAO and array buffer that are bound; locations match
+// include/vertex_input.glsl
+inline void SetupVertexAttributes()
+{
+    GLsizei stride = sizeof(PackedVertex);
+    glEnableVertexAttribArray(0);
+#if VERTEX_QUANTIZED_POSITIONS
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, position));
+#else
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+#endif
+    glEnableVertexAttribArray(1);
+#if VERTEX_OCTAHEDRAL_NORMALS
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+#else
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+#endif
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoords));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, tangent));
+}
+
+// points the instance attributes of the bound VAO at the bound array buffer, a mat4 per instance
+inline void SetupInstanceAttributes()
+{
+    // a mat4 attribute takes four consecutive locations, one column each
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(INSTANCE_MODEL_ATTRIBUTE + column);
+        glVertexAttribPointer(INSTANCE_MODEL_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(INSTANCE_MODEL_ATTRIBUTE + column, 1);
+    }
+}
+
+#endif
@@ -0,0 +1,635 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader_m.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/file_watcher.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/model.h>
+#include <learnopengl/model_loader.h>
+#include <learnopengl/render_queue.h>
+#include <learnopengl/scene_tree.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/uniform_buffer.h>
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// time per frame spent uploading meshes and textures while assets stream in
+#define LOAD_BUDGET_MS 4.0
+
+struct PointLight {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// the models placed in the scene, in the order they are loaded
+enum SceneObjectId {
+    OBJECT_LAZYBAG,
+    OBJECT_LAPTOP,
+    OBJECT_KAKTUS,
+    OBJECT_COUNT
+};
+
+struct MovingObject{
+    int kaktus = -1;
+    int laptop = -1;
+    int lazybag = -1;
+};
+
+PointLightData toLightData(const PointLight &light) {
+    PointLightData data;
+    data.position = light.position;
+    data.ambient = light.ambient;
+    data.diffuse = light.diffuse;
+    data.specular = light.specular;
+    data.constant = light.constant;
+    data.linear = light.linear;
+    data.quadratic = light.quadratic;
+    data.padding = 0.0f;
+    return data;
+}
+
+// textures with an alpha channel are clamped to the edge to prevent semi-transparent borders
+unsigned int loadTexture(char const * path, bool flipVertically = false)
+{
+    return TextureRegistry::Get().Acquire2D(path, flipVertically, true);
+}
+
+unsigned int loadCubemap(vector<std::string> faces)
+{
+    return TextureRegistry::Get().AcquireCubemap(faces);
+}
+
+// everything the game draws: shaders, models, the textured quads, the skybox and the per-frame uniform buffers.
+// the game and the headless benchmark both render through it, so they measure the same frame.
+// needs a current GL context for its whole life.
+class Scene {
+public:
+    Scene()
+            : lightingVariants("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs"),
+              skyboxShader("resources/shaders/6.1.skybox.vs", "resources/shaders/6.1.skybox.fs"),
+              transpShader("resources/shaders/transparentobj.vs", "resources/shaders/transparentobj.fs"),
+              placeholderShader("resources/shaders/placeholder.vs", "resources/shaders/placeholder.fs") {
+        loadingStart = Clock::now();
+        TraceScope trace("Scene");
+        // the lighting programs of plain and specular mapped materials, every model here uses one of them;
+        // the driver compiles them while the models load
+        lightingVariants.Prepare(LIGHTING_KEY);
+        lightingVariants.Prepare(LIGHTING_KEY | FEATURE_SPECULAR_MAP);
+        // and their multi-draw counterparts, which only the indirect batches use
+        if (MultiDraw::Indirect()) {
+            lightingVariants.Prepare(LIGHTING_KEY | FEATURE_INSTANCED_TRANSFORM);
+            lightingVariants.Prepare(LIGHTING_KEY | FEATURE_SPECULAR_MAP | FEATURE_INSTANCED_TRANSFORM);
+        }
+
+        // load models in the background, the render loop starts right away and shows placeholders until they arrive
+        ourModelLazyBag = modelLoader.Load("resources/objects/lazybag/10216_Bean_Bag_Chair_v2_max2008_it2.obj");
+        ourModelLapTop = modelLoader.Load("resources/objects/laptop/Laptop_High-Polay_HP_BI_2_obj.obj");
+        ourModelKaktus = modelLoader.Load("resources/objects/kaktus/kwiatek.obj");
+        // 2.model_lighting.fs samples material.texture_diffuse1 and so on
+        for (const ModelHandle &handle : {ourModelLazyBag, ourModelLapTop, ourModelKaktus})
+            handle->model.SetShaderTextureNamePrefix("material.");
+        sceneObjects[OBJECT_LAZYBAG].model = ourModelLazyBag;
+        sceneObjects[OBJECT_LAPTOP].model = ourModelLapTop;
+        sceneObjects[OBJECT_KAKTUS].model = ourModelKaktus;
+
+        // setting coordinates:
+
+        // transparent background square
+        float transparentVertices[] = {
+                // positions         // texture coordinates (non-swapped because stbi flips picture when loading)
+                0.0f,  0.5f,  0.0f,  0.0f,  1.0f,
+                0.0f, -0.5f,  0.0f,  0.0f,  0.0f,
+                1.0f, -0.5f,  0.0f,  1.0f,  0.0f,
+
+                0.0f,  0.5f,  0.0f,  0.0f,  1.0f,
+                1.0f, -0.5f,  0.0f,  1.0f,  0.0f,
+                1.0f,  0.5f,  0.0f,  1.0f,  1.0f
+        };
+
+
+        // skybox
+        float skyboxVertices[] = {
+                // positions
+                -1.0f,  1.0f, -1.0f,
+                -1.0f, -1.0f, -1.0f,
+                1.0f, -1.0f, -1.0f,
+                1.0f, -1.0f, -1.0f,
+                1.0f,  1.0f, -1.0f,
+                -1.0f,  1.0f, -1.0f,
+
+                -1.0f, -1.0f,  1.0f,
+                -1.0f, -1.0f, -1.0f,
+                -1.0f,  1.0f, -1.0f,
+                -1.0f,  1.0f, -1.0f,
+                -1.0f,  1.0f,  1.0f,
+                -1.0f, -1.0f,  1.0f,
+
+                1.0f, -1.0f, -1.0f,
+                1.0f, -1.0f,  1.0f,
+                1.0f,  1.0f,  1.0f,
+                1.0f,  1.0f,  1.0f,
+                1.0f,  1.0f, -1.0f,
+                1.0f, -1.0f, -1.0f,
+
+                -1.0f, -1.0f,  1.0f,
+                -1.0f,  1.0f,  1.0f,
+                1.0f,  1.0f,  1.0f,
+                1.0f,  1.0f,  1.0f,
+                1.0f, -1.0f,  1.0f,
+                -1.0f, -1.0f,  1.0f,
+
+                -1.0f,  1.0f, -1.0f,
+                1.0f,  1.0f, -1.0f,
+                1.0f,  1.0f,  1.0f,
+                1.0f,  1.0f,  1.0f,
+                -1.0f,  1.0f,  1.0f,
+                -1.0f,  1.0f, -1.0f,
+
+                -1.0f, -1.0f, -1.0f,
+                -1.0f, -1.0f,  1.0f,
+                1.0f, -1.0f, -1.0f,
+                1.0f, -1.0f, -1.0f,
+                -1.0f, -1.0f,  1.0f,
+                1.0f, -1.0f,  1.0f
+        };
+
+        float slikaVertices[] = {
+                // positions          // colors           // texture coords
+                0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
+                0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
+                -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
+                -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left
+        };
+        unsigned int indices[] = {
+                0,1,3,
+                1,2,3
+        };
+
+        // skybox VAO
+        glGenVertexArrays(1, &skyboxVAO);
+        glGenBuffers(1, &skyboxVBO);
+        glBindVertexArray(skyboxVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+        // dollar stash VAO
+        glGenVertexArrays(1, &transparentDollarVAO);
+        glGenBuffers(1, &transparentDollarVBO);
+        glBindVertexArray(transparentDollarVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, transparentDollarVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glBindVertexArray(0);
+
+        //DIAMOND VAO
+        glGenVertexArrays(1, &transparentDiamondVAO);
+        glGenBuffers(1, &transparentDiamondVBO);
+        glBindVertexArray(transparentDiamondVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, transparentDiamondVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glBindVertexArray(0);
+
+        // SLIKA EBO
+        glGenVertexArrays(1, &slikaVAO);
+        glGenBuffers(1, &slikaVBO);
+        glGenBuffers(1, &slikaEBO);
+        glBindVertexArray(slikaVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, slikaVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(slikaVertices), slikaVertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, slikaEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        // model space bounds of the quads for culling, the dollar and the diamond share their geometry
+        quadBounds = Bounds::FromPositions(transparentVertices, 6, 5);
+        slikaBounds = Bounds::FromPositions(slikaVertices, 4, 8);
+
+        // texture loading, decoded on the TextureLoader workers together with the model textures
+        transparentDollarTexture = loadTexture(FileSystem::getPath("resources/textures/dollars.png").c_str(), true);
+        transparentDiamondTexture = loadTexture(FileSystem::getPath("resources/textures/diamond.png").c_str(), true);
+        slikaTexture = loadTexture(FileSystem::getPath("resources/textures/tmp_slika.png").c_str(), true);
+
+        vector<std::string> faces
+                {
+                        FileSystem::getPath("resources/textures/skybox/px.jpg"),
+                        FileSystem::getPath("resources/textures/skybox/nx.jpg"),
+                        FileSystem::getPath("resources/textures/skybox/py.jpg"),
+                        FileSystem::getPath("resources/textures/skybox/ny.jpg"),
+                        FileSystem::getPath("resources/textures/skybox/pz.jpg"),
+                        FileSystem::getPath("resources/textures/skybox/nz.jpg")
+                };
+
+        cubemapTexture = loadCubemap(faces);
+
+        // the programs were only submitted by the member initializers, the driver compiled them while the loads above
+        // got going; wait for them here, whichever finishes first is checked first
+        Shader::finishAll({&skyboxShader, &transpShader, &placeholderShader});
+
+        // camera and lights live in uniform buffers written once per frame, every program reads them from there
+        frameBuffer.Create(sizeof(FrameData), FRAME_DATA_BINDING);
+        lightBuffer.Create(sizeof(LightData), LIGHT_DATA_BINDING);
+        setupPrograms();
+        lightingVariants.OnFirstUse([](Shader &shader) {
+            shader.bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+            shader.bindUniformBlock("LightData", LIGHT_DATA_BINDING);
+            shader.use();
+            shader.setFloat("material.shininess", 32.0f);
+        });
+
+        // shader hot reload: watch every directory a shader file came from
+        std::set<std::string> directories;
+        forEachShader([&](Shader &shader) {
+            for (const std::string &file : shader.sourceFiles())
+                directories.insert(file.substr(0, file.find_last_of('/')));
+        });
+        shaderWatcher.Watch(std::vector<std::string>(directories.begin(), directories.end()));
+
+        // the VAO setup above bound things directly, start rendering from a clean slate
+        GLState::Get().Invalidate();
+    }
+
+    // once per frame: streams in whatever finished loading in the background and swaps in reloaded shaders
+    void Update() {
+        modelLoader.Update(LOAD_BUDGET_MS);
+        reloadShaders();
+        if (loadMilliseconds < 0.0 && modelLoader.Idle()) {
+            loadMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - loadingStart).count();
+            std::cout << "LOADING:: all assets ready after " << loadMilliseconds << " ms" << std::endl;
+            MeshCache::PrintReport();
+            MeshOptimizer::PrintReport();
+            GeometryArena::Get().PrintReport();
+            ProgramCache::PrintReport();
+            TextureLoader::Get().PrintReport();
+            TextureRegistry::Get().PrintReport();
+        }
+    }
+
+    // "file: log" of every shader whose last hot reload failed; those keep drawing with the program they had
+    std::vector<std::string> ShaderErrors() const {
+        std::vector<std::string> errors;
+        auto collect = [&](const Shader &shader) {
+            if (!shader.reloadError().empty())
+                errors.push_back(shader.path() + ": " + shader.reloadError());
+        };
+        for (const Shader *shader : {&skyboxShader, &transpShader, &placeholderShader})
+            collect(*shader);
+        lightingVariants.ForEach(collect);
+        return errors;
+    }
+
+    // time from construction until every model and texture was uploaded, negative while still loading
+    double LoadMilliseconds() const { return loadMilliseconds; }
+
+    // draws issued by the last Render()
+    size_t DrawCount() const { return renderQueue.Size(); }
+
+    // triangles drawn by the last Render()
+    size_t TriangleCount() const { return renderQueue.Triangles(); }
+    // draw calls the last Render() issued once runs of opaque meshes were merged into multi-draws
+    size_t CallCount() const { return renderQueue.Calls(); }
+
+    // meshes, placeholder boxes and quads that passed and failed the frustum test in the last Render()
+    const CullingCounters &Culling() const { return culling; }
+
+    // the loaded model hit first by a ray from the camera along its view direction, -1 when there is none
+    int Pick(const Camera &camera, float maxDistance = 100.0f) {
+        PickHit hit = tree.Pick(Ray(camera.Position, camera.Front), maxDistance);
+        return hit.item < 0 ? -1 : (int) hit.owner;
+    }
+
+    // renders one frame into the bound framebuffer, which is expected to be cleared already
+    void Render(const Camera &camera, const MovingObject &objects, bool dollarCollected, bool diamondCollected, float aspect) {
+        Profiler::Get().Begin("scene setup");
+        // point lights
+        PointLight pointLight;
+        pointLight.position = glm::vec3(4.0f, 4.0, 0.0);
+        pointLight.ambient = glm::vec3(0.1, 0.1, 0.1);
+        pointLight.diffuse = glm::vec3(0.6, 0.6, 0.6);
+        pointLight.specular = glm::vec3(1.0, 1.0, 1.0);
+
+        pointLight.constant = 0.1f;
+        pointLight.linear = 0.03f;
+        pointLight.quadratic = 0.032f;
+
+        LightData lights;
+        // pointLight1
+        pointLight.position = glm::vec3(7.5f, 1.0f, 6.5f);
+        lights.pointLights[0] = toLightData(pointLight);
+
+        // pointLight2
+        pointLight.position = glm::vec3(5.0f, 0.7f, 16.5f);
+        lights.pointLights[1] = toLightData(pointLight);
+
+        //spotlight:
+        lights.spotLight.position = camera.Position;
+        lights.spotLight.direction = camera.Front;
+        lights.spotLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+        lights.spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+        lights.spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+        lights.spotLight.constant = 0.5f;
+        lights.spotLight.linear = 0.03f;
+        lights.spotLight.quadratic = 0.032f;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(15.0f));
+        lightBuffer.Update(lights);
+
+        FrameData frame;
+        frame.projection = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f);
+        frame.view = camera.GetViewMatrix();
+        frame.viewPosition = glm::vec4(camera.Position, 1.0f);
+        frameBuffer.Update(frame);
+
+        frustum.Set(frame.projection * frame.view);
+        culling = CullingCounters();
+        renderQueue.Begin(camera.Position, 100.0f);
+
+        // rendering loaded models
+
+        //LAZYBAG
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model,glm::vec3(-2.5f,-1.0f,10.5f) + (float)objects.lazybag * glm::vec3(0.0f, 0.0f, 0.7f));
+        model = glm::rotate(model,glm::radians(50.0f),glm::vec3(1.0,0,0));
+        model = glm::rotate(model,glm::radians(80.0f),glm::vec3(0,0,1.0));
+        model = glm::rotate(model,glm::radians(150.0f),glm::vec3(0,1.0,0));
+        model = glm::scale(model, glm::vec3(0.017f,0.017f,0.017f));    // it's a bit too big for our scene, so scale it down
+        placeObject(OBJECT_LAZYBAG, model);
+
+        //LAPTOP
+        model = glm::mat4(1.0f);
+        model = glm::translate(model,glm::vec3(8.0f, -3.0f, 13.0f) + (float)objects.laptop * glm::vec3(0.0f, 0.0f, 2.0f));
+        model = glm::rotate(model,glm::radians(30.0f),glm::vec3(0.0,1.0,0.0));
+        model = glm::scale(model, glm::vec3(0.5f));
+        placeObject(OBJECT_LAPTOP, model);
+
+        //KAKTUS
+        model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(6.0f,-5.5f,3.5f) + (float)objects.kaktus * glm::vec3(-2.0f, 0.0f, 0.0f));
+        model = glm::rotate(model,glm::radians(-90.0f),glm::vec3(1.0,0,0.0));
+        model = glm::scale(model, glm::vec3(0.065f,0.065f,0.065f));
+        placeObject(OBJECT_KAKTUS, model);
+
+        // every loaded mesh whose box the BVH finds inside the frustum
+        unsigned int visibleMeshes = 0;
+        tree.Query(frustum, [&](unsigned int item) {
+            DrawPacket packet;
+            packet.mesh = tree.MeshOf(item);
+            // the cheapest lighting program that covers the mesh's material
+            const ShaderVariants::Variant &variant = lightingVariants.Get(LIGHTING_KEY | packet.mesh->features);
+            packet.shader = variant.shader.get();
+            packet.modelUniform = variant.model;
+            packet.transform = tree.Transform(item);
+            if (MultiDraw::Indirect())
+                packet.batchShader = lightingVariants.Get(LIGHTING_KEY | FEATURE_INSTANCED_TRANSFORM | packet.mesh->features).shader.get();
+            renderQueue.Submit(packet);
+            visibleMeshes++;
+        });
+        culling.visible += visibleMeshes;
+        culling.culled += tree.Size() - visibleMeshes;
+
+        // transparent objects
+        // DOLLAR object
+        if(!dollarCollected && !TextureLoader::Get().Pending(transparentDollarTexture)){
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(-3.5f, -7.0f, 25.0f));
+            model = glm::scale(model, glm::vec3(2.5f, 2.5f, 2.5f));
+            submitQuad(transparentDollarVAO, transparentDollarTexture, 6, false, quadBounds, model);
+        }
+
+        //DIAMOND object
+        if(!diamondCollected && !TextureLoader::Get().Pending(transparentDiamondTexture)){
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(10.0f, -5.0f, 3.5f));
+            model = glm::rotate(model, glm::radians(98.0f), glm::vec3(0.0, 1.0, 0.0));
+            submitQuad(transparentDiamondVAO, transparentDiamondTexture, 6, false, quadBounds, model);
+        }
+
+        // picture
+        if(!TextureLoader::Get().Pending(slikaTexture)){
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(7.5f, 2.0f, 4.5f));
+            model = glm::rotate(model,glm::radians(90.0f),glm::vec3(0.0,1.0,0.0));
+            model = glm::scale(model,glm::vec3(1.5f));
+            submitQuad(slikaVAO, slikaTexture, 6, true, slikaBounds, model);
+        }
+
+        // skybox after the opaque pass, so only the pixels nothing covers run its shader
+        DrawPacket skybox;
+        skybox.pass = PASS_SKYBOX;
+        skybox.shader = &skyboxShader;
+        skybox.vertexArray = skyboxVAO;
+        skybox.texture = cubemapTexture;
+        skybox.textureTarget = GL_TEXTURE_CUBE_MAP;
+        skybox.count = 36;
+        skybox.depthFunc = GL_LEQUAL; // depth test passes when values are equal to depth buffer's content
+        renderQueue.Submit(skybox);
+
+        renderQueue.Sort();
+        Profiler::Get().End();
+        renderQueue.Execute();
+    }
+
+    void Delete() {
+        TextureRegistry::Get().Release(transparentDollarTexture);
+        TextureRegistry::Get().Release(transparentDiamondTexture);
+        TextureRegistry::Get().Release(slikaTexture);
+        TextureRegistry::Get().Release(cubemapTexture);
+        modelLoader.Delete();
+        placeholder.Delete();
+
+        frameBuffer.Delete();
+        lightBuffer.Delete();
+        renderQueue.Delete();
+        GeometryArena::Get().Delete();
+
+        unsigned int vertexArrays[] = {skyboxVAO, transparentDollarVAO, transparentDiamondVAO, slikaVAO};
+        unsigned int buffers[] = {skyboxVBO, transparentDollarVBO, transparentDiamondVBO, slikaVBO, slikaEBO};
+        for (unsigned int vao : vertexArrays)
+            GLState::Get().ForgetVertexArray(vao);
+        glDeleteVertexArrays(4, vertexArrays);
+        glDeleteBuffers(5, buffers);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // model lighting with every light of LightData, one program per material the loaded meshes have
+    static const unsigned int LIGHTING_KEY = NR_POINT_LIGHTS << SHADER_VARIANT_LIGHT_SHIFT | FEATURE_SPOT_LIGHT;
+    ShaderVariants lightingVariants;
+    Shader skyboxShader, transpShader, placeholderShader;
+    FileWatcher shaderWatcher;
+    ModelLoader modelLoader;
+    ModelHandle ourModelLazyBag, ourModelLapTop, ourModelKaktus;
+    ModelPlaceholder placeholder;
+
+    unsigned int skyboxVAO, skyboxVBO;
+    unsigned int transparentDollarVAO, transparentDollarVBO;
+    unsigned int transparentDiamondVAO, transparentDiamondVBO;
+    unsigned int slikaVBO, slikaVAO, slikaEBO;
+    unsigned int transparentDollarTexture, transparentDiamondTexture, slikaTexture, cubemapTexture;
+    Bounds quadBounds, slikaBounds;
+
+    UniformBuffer frameBuffer, lightBuffer;
+    UniformHandle transpModelUniform, placeholderModelUniform;
+    // draws are collected here during the frame and issued sorted by state and depth
+    RenderQueue renderQueue;
+    // camera frustum of the current frame, everything outside of it is not submitted
+    Frustum frustum;
+    CullingCounters culling;
+
+    // a placed model and the range of its meshes in the tree
+    struct SceneObject {
+        ModelHandle  model;
+        glm::mat4    transform = glm::mat4(0.0f);
+        bool         inTree = false;
+        unsigned int firstItem = 0;
+        unsigned int itemCount = 0;
+    };
+    SceneObject sceneObjects[OBJECT_COUNT];
+    // every mesh of the loaded models in world space, for culling and picking; the owner of an item is its SceneObjectId
+    SceneTree   tree;
+
+    Clock::time_point loadingStart;
+    double loadMilliseconds = -1.0;
+
+    bool visible(const Bounds &bounds, const glm::mat4 &model) {
+        bool inside = frustum.Visible(bounds, model);
+        if (inside)
+            culling.visible++;
+        else
+            culling.culled++;
+        return inside;
+    }
+
+    // every program the scene draws with, the lighting variants included
+    template <typename F>
+    void forEachShader(F f) {
+        for (Shader *shader : {&skyboxShader, &transpShader, &placeholderShader})
+            f(*shader);
+        lightingVariants.ForEach(f);
+    }
+
+    // the uniforms of the fixed programs that never change and their per-draw handles, again after a hot reload
+    void setupPrograms() {
+        transpShader.use();
+        transpShader.setInt("texture1", 0);
+
+        skyboxShader.use();
+        skyboxShader.setInt("skybox", 0);
+
+        placeholderShader.use();
+        placeholderShader.setVec3("color", 0.6f, 0.6f, 0.65f);
+
+        for (Shader *shader : {&skyboxShader, &transpShader, &placeholderShader}) {
+            shader->bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+            shader->bindUniformBlock("LightData", LIGHT_DATA_BINDING);
+        }
+
+        // per-draw uniforms, resolved once instead of on every set call
+        transpModelUniform = transpShader.uniform("model");
+        placeholderModelUniform = placeholderShader.uniform("model");
+    }
+
+    // rebuilds the programs whose files changed on disk; the driver compiles them while the old ones keep drawing,
+    // each is swapped in on the first frame it is ready. a failed build leaves the old program and an error
+    void reloadShaders() {
+        std::vector<std::string> changed = shaderWatcher.TakeChanges();
+        forEachShader([&](Shader &shader) {
+            for (const std::string &file : changed) {
+                if (shader.sourceFiles().count(file)) {
+                    std::cout << "SHADER:: reloading " << shader.path() << " after " << file << " changed" << std::endl;
+                    shader.reload();
+                    break;
+                }
+            }
+        });
+        bool swapped = false;
+        for (Shader *shader : {&skyboxShader, &transpShader, &placeholderShader})
+            swapped = shader->pollReload() || swapped;
+        if (swapped)
+            setupPrograms();
+        lightingVariants.PollReloads();
+    }
+
+    // moves a model to its transform for this frame. its meshes join the BVH once it is fully loaded,
+    // until then its placeholder box is queued if visible.
+    void placeObject(unsigned int id, const glm::mat4 &model) {
+        SceneObject &object = sceneObjects[id];
+        bool moved = object.transform != model;
+        object.transform = model;
+
+        if (object.model->Ready()) {
+            if (!object.inTree) {
+                object.firstItem = tree.Size();
+                object.itemCount = (unsigned int) object.model->model.meshes.size();
+                for (Mesh &mesh : object.model->model.meshes)
+                    tree.Add(&mesh, model, id);
+                object.inTree = true;
+            } else if (moved) {
+                for (unsigned int item = object.firstItem; item < object.firstItem + object.itemCount; item++)
+                    tree.Move(item, model);
+            }
+            return;
+        }
+
+        DrawPacket packet;
+        if (placeholder.Box(*object.model, model, packet.transform)
+            && visible(Bounds::FromBox(glm::vec3(-0.5f), glm::vec3(0.5f)), packet.transform)) {
+            packet.shader = &placeholderShader;
+            packet.modelUniform = placeholderModelUniform;
+            packet.vertexArray = placeholder.VertexArray();
+            packet.count = 36;
+            renderQueue.Submit(packet);
+        }
+    }
+
+    // queues one of the textured quads of the transparent pass, if it is visible
+    void submitQuad(unsigned int vertexArray, unsigned int texture, unsigned int count, bool indexed,
+                    const Bounds &bounds, const glm::mat4 &model) {
+        if (!visible(bounds, model))
+            return;
+        DrawPacket packet;
+        packet.pass = PASS_TRANSPARENT;
+        packet.shader = &transpShader;
+        packet.modelUniform = transpModelUniform;
+        packet.vertexArray = vertexArray;
+        packet.texture = texture;
+        packet.count = count;
+        packet.indexed = indexed;
+        packet.transform = model;
+        renderQueue.Submit(packet);
+    }
+};
+
+#endif
@@ -1,2 +1,7 @@
+// TextureLoader decodes on several threads at once. stb_image keeps its failure reason (and the name of unknown
+// PNG chunks) in unsynchronized globals, so failure strings are compiled out; the GIF loader resets that global
+// even then and is left out too, no texture here is a GIF
+#define STBI_NO_FAILURE_STRINGS
+#define STBI_NO_GIF
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"
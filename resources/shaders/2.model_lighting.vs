@@ -1,20 +1,33 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoords;
+#include "include/model_variants.glsl"
+#include "include/vertex_input.glsl"
 
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
+#if HAS_NORMAL_MAP
+// tangent space to world space, for the normal map
+out mat3 TBN;
+#endif
 
+#if INSTANCED_TRANSFORM
+layout (location = 5) in mat4 aInstanceModel;
+#define model aInstanceModel
+#else
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#endif
+
+#include "include/frame_data.glsl"
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = aNormal;
-    TexCoords = aTexCoords;    
+    FragPos = vec3(model * vec4(vertexPosition(), 1.0));
+    Normal = vertexNormal();
+    TexCoords = aTexCoords;
+#if HAS_NORMAL_MAP
+    mat3 normalMatrix = mat3(model);
+    vec3 tangent = vertexTangent();
+    TBN = mat3(normalize(normalMatrix * tangent), normalize(normalMatrix * vertexBitangent(Normal, tangent)), normalize(normalMatrix * Normal));
+#endif
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,18 @@
+#version 330 core
+#include "include/vertex_input.glsl"
+// model matrix of the instance, takes locations 5 to 8 (INSTANCE_MODEL_ATTRIBUTE in vertex_format.h)
+layout (location = 5) in mat4 aInstanceModel;
+
+out vec2 TexCoords;
+out vec3 Normal;
+out vec3 FragPos;
+
+#include "include/frame_data.glsl"
+
+void main()
+{
+    FragPos = vec3(aInstanceModel * vec4(vertexPosition(), 1.0));
+    Normal = vertexNormal();
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,6 @@
+// per-frame camera data, written once per frame into a uniform buffer shared by all programs (FrameData in uniform_buffer.h)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+};
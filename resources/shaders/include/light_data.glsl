@@ -0,0 +1,31 @@
+// members are ordered so that each vec3 shares a 16 byte slot with a float, matching LightData in uniform_buffer.h
+struct PointLight {
+    vec3 position;
+    float constant;
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    float constant;
+    vec3 direction;
+    float linear;
+    vec3 ambient;
+    float quadratic;
+    vec3 diffuse;
+    float cutOff;
+    vec3 specular;
+    float outerCutOff;
+};
+
+// the block always holds every light the buffer has, POINT_LIGHTS only decides how many of them are shaded
+#define NR_POINT_LIGHTS 2
+
+layout (std140) uniform LightData {
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+};
@@ -0,0 +1,25 @@
+// keywords of the model lighting variants, ShaderVariants (shader_variants.h) defines all of them.
+// a plain compile without defines gets the defaults, which shade every light and sample a specular map
+#ifndef POINT_LIGHTS
+#define POINT_LIGHTS 2
+#endif
+// 1 to add the spot light
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+// specular strength from texture_specular1, no highlights without it
+#ifndef HAS_SPECULAR_MAP
+#define HAS_SPECULAR_MAP 1
+#endif
+// normals from texture_normal1 in tangent space
+#ifndef HAS_NORMAL_MAP
+#define HAS_NORMAL_MAP 0
+#endif
+// discard where the diffuse alpha is below 0.1
+#ifndef ALPHA_TEST
+#define ALPHA_TEST 0
+#endif
+// the model matrix from the instance attribute at location 5 (a multi-draw batch) instead of the model uniform
+#ifndef INSTANCED_TRANSFORM
+#define INSTANCED_TRANSFORM 0
+#endif
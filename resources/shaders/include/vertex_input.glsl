@@ -0,0 +1,49 @@
+// mesh vertex attributes as Mesh uploads them (PackedVertex in vertex_format.h), read through the functions below.
+// VERTEX_QUANTIZED_POSITIONS and VERTEX_OCTAHEDRAL_NORMALS are defined by the Shader class from the same header
+layout (location = 0) in vec3 aPos;
+#if VERTEX_OCTAHEDRAL_NORMALS
+layout (location = 1) in vec2 aNormal;
+#else
+layout (location = 1) in vec3 aNormal;
+#endif
+layout (location = 2) in vec2 aTexCoords;
+// w is the sign of the bitangent; a 2-bit -1 may come out as -1/3 on older drivers, only its sign counts
+layout (location = 3) in vec4 aTangent;
+
+#if VERTEX_QUANTIZED_POSITIONS
+// bounds of the mesh, set per draw by Mesh
+uniform vec3 positionMin;
+uniform vec3 positionExtent;
+#endif
+
+vec3 vertexPosition()
+{
+#if VERTEX_QUANTIZED_POSITIONS
+    return positionMin + aPos * positionExtent;
+#else
+    return aPos;
+#endif
+}
+
+vec3 vertexNormal()
+{
+#if VERTEX_OCTAHEDRAL_NORMALS
+    vec3 n = vec3(aNormal, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    // unfold the lower half of the octahedron
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+#else
+    return aNormal;
+#endif
+}
+
+vec3 vertexTangent()
+{
+    return aTangent.xyz;
+}
+
+vec3 vertexBitangent(vec3 normal, vec3 tangent)
+{
+    return cross(normal, tangent) * (aTangent.w < 0.0 ? -1.0 : 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 Normal;
+
+uniform vec3 color;
+
+void main()
+{
+    // flat shading from a fixed direction, just enough to read the shape of the box
+    float light = 0.35 + 0.65 * max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.3))), 0.0);
+    FragColor = vec4(color * light, 1.0);
+}
@@ -12,11 +12,13 @@
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
-#include <learnopengl/model.h>
+#include <scene.h>
 
 #include <iostream>
 
 #define TIMER_START 60.0
+// written on exit and on F12, open it in chrome://tracing or ui.perfetto.dev
+#define TRACE_FILE "trace.json"
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -28,9 +30,6 @@ void processInput(GLFWwindow *window);
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
-unsigned int loadTexture(const char *path);
-unsigned int loadCubemap(vector<std::string> faces);
-
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -45,23 +44,6 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-struct PointLight {
-    glm::vec3 position;
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-struct MovingObject{
-    int kaktus = -1;
-    int laptop = -1;
-    int lazybag = -1;
-};
-
 struct ProgramState {
     glm::vec3 clearColor = glm::vec3(0);
     bool ImGuiEnabled = false;
@@ -73,7 +55,6 @@ struct ProgramState {
     bool dollarCollected = false;
     //glm::vec3 backpackPosition = glm::vec3(0.0f);
     //float backpackScale = 1.0f;
-    PointLight pointLight;
     ProgramState()
             : camera(glm::vec3(-2.32,0.54,5.87)) {}
 
@@ -115,9 +96,12 @@ void ProgramState::LoadFromFile(std::string filename) {
 ProgramState *programState;
 MovingObject movingObject;
 
-void DrawImGui(ProgramState *programState);
+void DrawImGui(ProgramState *programState, const Scene &scene);
 
 int main() {
+    Trace::Get().SetThreadName("main");
+    uint64_t startupBegin = Trace::Get().Now();
+
     // glfw: initialize and configure
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -148,6 +132,8 @@ int main() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    GLExtensions::Get().Load((GLADloadproc) glfwGetProcAddress);
+    Trace::Get().Record("glfw + glad init", startupBegin, Trace::Get().Now());
 
     programState = new ProgramState;
     programState->LoadFromFile("resources/program_state.txt");
@@ -155,6 +141,7 @@ int main() {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
     }
     // Init Imgui
+    uint64_t imguiBegin = Trace::Get().Now();
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO();
@@ -162,179 +149,18 @@ int main() {
 
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330 core");
+    Trace::Get().Record("imgui init", imguiBegin, Trace::Get().Now());
 
     // configure global opengl state
     glEnable(GL_DEPTH_TEST);
 
-    // build and compile shaders
-    Shader ourShader("resources/shaders/2.model_lighting.vs", "resources/shaders/2.model_lighting.fs");
-    Shader skyboxShader("resources/shaders/6.1.skybox.vs", "resources/shaders/6.1.skybox.fs");
-    Shader transpShader("resources/shaders/transparentobj.vs", "resources/shaders/transparentobj.fs");
-
-    // load models
-    Model ourModelLazyBag("resources/objects/lazybag/10216_Bean_Bag_Chair_v2_max2008_it2.obj");
-    Model ourModelLapTop("resources/objects/laptop/Laptop_High-Polay_HP_BI_2_obj.obj");
-    Model ourModelKaktus("resources/objects/kaktus/kwiatek.obj");
-    ourModelLazyBag.SetShaderTextureNamePrefix("material.");
-
+    // shaders, models, textures and geometry; models and textures keep loading in the background
+    Scene scene;
+    // key_callback picks through it
+    glfwSetWindowUserPointer(window, &scene);
 
-    glEnable(GL_DEPTH_TEST);
-
-    // setting coordinates:
-
-    // transparent background square
-    float transparentVertices[] = {
-            // positions         // texture coordinates (non-swapped because stbi flips picture when loading)
-            0.0f,  0.5f,  0.0f,  0.0f,  1.0f,
-            0.0f, -0.5f,  0.0f,  0.0f,  0.0f,
-            1.0f, -0.5f,  0.0f,  1.0f,  0.0f,
-
-            0.0f,  0.5f,  0.0f,  0.0f,  1.0f,
-            1.0f, -0.5f,  0.0f,  1.0f,  0.0f,
-            1.0f,  0.5f,  0.0f,  1.0f,  1.0f
-    };
-
-
-    // skybox
-    float skyboxVertices[] = {
-            // positions
-            -1.0f,  1.0f, -1.0f,
-            -1.0f, -1.0f, -1.0f,
-            1.0f, -1.0f, -1.0f,
-            1.0f, -1.0f, -1.0f,
-            1.0f,  1.0f, -1.0f,
-            -1.0f,  1.0f, -1.0f,
-
-            -1.0f, -1.0f,  1.0f,
-            -1.0f, -1.0f, -1.0f,
-            -1.0f,  1.0f, -1.0f,
-            -1.0f,  1.0f, -1.0f,
-            -1.0f,  1.0f,  1.0f,
-            -1.0f, -1.0f,  1.0f,
-
-            1.0f, -1.0f, -1.0f,
-            1.0f, -1.0f,  1.0f,
-            1.0f,  1.0f,  1.0f,
-            1.0f,  1.0f,  1.0f,
-            1.0f,  1.0f, -1.0f,
-            1.0f, -1.0f, -1.0f,
-
-            -1.0f, -1.0f,  1.0f,
-            -1.0f,  1.0f,  1.0f,
-            1.0f,  1.0f,  1.0f,
-            1.0f,  1.0f,  1.0f,
-            1.0f, -1.0f,  1.0f,
-            -1.0f, -1.0f,  1.0f,
-
-            -1.0f,  1.0f, -1.0f,
-            1.0f,  1.0f, -1.0f,
-            1.0f,  1.0f,  1.0f,
-            1.0f,  1.0f,  1.0f,
-            -1.0f,  1.0f,  1.0f,
-            -1.0f,  1.0f, -1.0f,
-
-            -1.0f, -1.0f, -1.0f,
-            -1.0f, -1.0f,  1.0f,
-            1.0f, -1.0f, -1.0f,
-            1.0f, -1.0f, -1.0f,
-            -1.0f, -1.0f,  1.0f,
-            1.0f, -1.0f,  1.0f
-    };
-
-    float slikaVertices[] = {
-            // positions          // colors           // texture coords
-            0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
-            0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
-            -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
-            -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left
-    };
-    unsigned int indices[] = {
-            0,1,3,
-            1,2,3
-    };
-
-    // skybox VAO
-    unsigned int skyboxVAO, skyboxVBO;
-    glGenVertexArrays(1, &skyboxVAO);
-    glGenBuffers(1, &skyboxVBO);
-    glBindVertexArray(skyboxVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-
-    // dollar stash VAO
-    unsigned int transparentDollarVAO, transparentDollarVBO;
-    glGenVertexArrays(1, &transparentDollarVAO);
-    glGenBuffers(1, &transparentDollarVBO);
-    glBindVertexArray(transparentDollarVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, transparentDollarVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glBindVertexArray(0);
-
-    //DIAMOND VAO
-    unsigned int transparentDiamondVAO, transparentDiamondVBO;
-    glGenVertexArrays(1, &transparentDiamondVAO);
-    glGenBuffers(1, &transparentDiamondVBO);
-    glBindVertexArray(transparentDiamondVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, transparentDiamondVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glBindVertexArray(0);
-
-    // SLIKA EBO
-    unsigned int slikaVBO, slikaVAO, slikaEBO;
-    glGenVertexArrays(1, &slikaVAO);
-    glGenBuffers(1, &slikaVBO);
-    glGenBuffers(1, &slikaEBO);
-    glBindVertexArray(slikaVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, slikaVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(slikaVertices), slikaVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, slikaEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-
-    // texture loading
-    stbi_set_flip_vertically_on_load(true);
-
-    unsigned int transparentDollarTexture = loadTexture(FileSystem::getPath("resources/textures/dollars.png").c_str());
-    unsigned int transparentDiamondTexture = loadTexture(FileSystem::getPath("resources/textures/diamond.png").c_str());
-    unsigned int slikaTexture = loadTexture(FileSystem::getPath("resources/textures/tmp_slika.png").c_str());
-
-    stbi_set_flip_vertically_on_load(false);
-
-
-    vector<std::string> faces
-            {
-                    FileSystem::getPath("resources/textures/skybox/px.jpg"),
-                    FileSystem::getPath("resources/textures/skybox/nx.jpg"),
-                    FileSystem::getPath("resources/textures/skybox/py.jpg"),
-                    FileSystem::getPath("resources/textures/skybox/ny.jpg"),
-                    FileSystem::getPath("resources/textures/skybox/pz.jpg"),
-                    FileSystem::getPath("resources/textures/skybox/nz.jpg")
-            };
-
-    unsigned int cubemapTexture = loadCubemap(faces);
-
-    transpShader.use();
-    transpShader.setInt("texture1", 0);
-
-    skyboxShader.use();
-    skyboxShader.setInt("skybox", 0);
+    double loadingStart = glfwGetTime();
+    bool firstFrame = true;
 
     // render loop
     while (!glfwWindowShouldClose(window)) {
@@ -342,6 +168,10 @@ int main() {
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        Profiler::Get().BeginFrame();
+
+        // stream in whatever finished loading in the background
+        scene.Update();
 
         // input
         processInput(window);
@@ -351,168 +181,33 @@ int main() {
         glClearColor(programState->clearColor.r, programState->clearColor.g, programState->clearColor.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // point lights
-        PointLight& pointLight = programState->pointLight;
-        pointLight.position = glm::vec3(4.0f, 4.0, 0.0);
-        pointLight.ambient = glm::vec3(0.1, 0.1, 0.1);
-        pointLight.diffuse = glm::vec3(0.6, 0.6, 0.6);
-        pointLight.specular = glm::vec3(1.0, 1.0, 1.0);
-
-        pointLight.constant = 0.1f;
-        pointLight.linear = 0.03f;
-        pointLight.quadratic = 0.032f;
-
-        ourShader.use();
-        // pointLight1
-        pointLight.position = glm::vec3(7.5f, 1.0f, 6.5f);
-        ourShader.setVec3("pointLight.position", pointLight.position);
-        ourShader.setVec3("pointLight.ambient", pointLight.ambient);
-        ourShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        ourShader.setVec3("pointLight.specular", pointLight.specular);
-        ourShader.setFloat("pointLight.constant", pointLight.constant);
-        ourShader.setFloat("pointLight.linear", pointLight.linear);
-        ourShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        ourShader.setVec3("viewPosition", programState->camera.Position);
-        ourShader.setFloat("material.shininess", 32.0f);
-
-        // pointLight2
-        pointLight.position = glm::vec3(5.0f, 0.7f, 16.5f);
-        ourShader.setVec3("pointLight1.position", pointLight.position);
-        ourShader.setVec3("pointLight1.ambient", pointLight.ambient);
-        ourShader.setVec3("pointLight1.diffuse", pointLight.diffuse);
-        ourShader.setVec3("pointLight1.specular", pointLight.specular);
-        ourShader.setFloat("pointLight1.constant", pointLight.constant);
-        ourShader.setFloat("pointLight1.linear", pointLight.linear);
-        ourShader.setFloat("pointLight1.quadratic", pointLight.quadratic);
-        ourShader.setVec3("viewPosition", programState->camera.Position);
-        ourShader.setFloat("material.shininess", 32.0f);
-
-        //spotlight:
-        ourShader.setVec3("spotLight.position", programState->camera.Position);
-        ourShader.setVec3("spotLight.direction", programState->camera.Front);
-        ourShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        ourShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-        ourShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-        ourShader.setFloat("spotLight.constant", 0.5f);
-        ourShader.setFloat("spotLight.linear", 0.03);
-        ourShader.setFloat("spotLight.quadratic", 0.032);
-        ourShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        ourShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));
-
-
-        glm::mat4 projection = glm::perspective(glm::radians(programState->camera.Zoom), (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = programState->camera.GetViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-
-        // rendering loaded models
-
-        //LAZYBAG
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model,glm::vec3(-2.5f,-1.0f,10.5f) + (float)movingObject.lazybag * glm::vec3(0.0f, 0.0f, 0.7f));
-        model = glm::rotate(model,glm::radians(50.0f),glm::vec3(1.0,0,0));
-        model = glm::rotate(model,glm::radians(80.0f),glm::vec3(0,0,1.0));
-        model = glm::rotate(model,glm::radians(150.0f),glm::vec3(0,1.0,0));
-        model = glm::scale(model, glm::vec3(0.017f,0.017f,0.017f));    // it's a bit too big for our scene, so scale it down
-        ourShader.setMat4("model", model);
-        ourModelLazyBag.Draw(ourShader);
-
-        //LAPTOP
-        model = glm::mat4(1.0f);
-        model = glm::translate(model,glm::vec3(8.0f, -3.0f, 13.0f) + (float)movingObject.laptop * glm::vec3(0.0f, 0.0f, 2.0f));
-        model = glm::rotate(model,glm::radians(30.0f),glm::vec3(0.0,1.0,0.0));
-        model = glm::scale(model, glm::vec3(0.5f));
-        ourShader.setMat4("model", model);
-        ourModelLapTop.Draw(ourShader);
-
-        //KAKTUS
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(6.0f,-5.5f,3.5f) + (float)movingObject.kaktus * glm::vec3(-2.0f, 0.0f, 0.0f));
-        model = glm::rotate(model,glm::radians(-90.0f),glm::vec3(1.0,0,0.0));
-        model = glm::scale(model, glm::vec3(0.065f,0.065f,0.065f));
-        ourShader.setMat4("model", model);
-        ourModelKaktus.Draw(ourShader);
-
-        // transparent objects
-        // DOLLAR object
-        if(!programState->dollarCollected){
-            transpShader.use();
-            projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                          (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-            view = programState->camera.GetViewMatrix();
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(-3.5f, -7.0f, 25.0f));
-            model = glm::scale(model, glm::vec3(2.5f, 2.5f, 2.5f));
-
-            transpShader.setMat4("model", model);
-            transpShader.setMat4("projection", projection);
-            transpShader.setMat4("view", view);
-
-            glBindVertexArray(transparentDollarVAO);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, transparentDollarTexture);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-        }
+        scene.Render(programState->camera, movingObject, programState->dollarCollected, programState->diamondColected,
+                     (float) SCR_WIDTH / (float) SCR_HEIGHT);
 
-        //DIAMOND object
-        if(!programState->diamondColected){
-            transpShader.use();
-            projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                          (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-            view = programState->camera.GetViewMatrix();
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(10.0f, -5.0f, 3.5f));
-            model = glm::rotate(model, glm::radians(98.0f), glm::vec3(0.0, 1.0, 0.0));
-
-            transpShader.setMat4("model", model);
-            transpShader.setMat4("projection", projection);
-            transpShader.setMat4("view", view);
-
-            glBindVertexArray(transparentDiamondVAO);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, transparentDiamondTexture);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        GLState::Get().EndFrame();
+        if (programState->ImGuiEnabled) {
+            ProfileZone zone("imgui");
+            DrawImGui(programState, scene);
+            // ImGui sets program, textures, VAO and blending behind GLState's back
+            GLState::Get().Invalidate();
         }
 
-        // picture
-        glBindTexture(GL_TEXTURE_2D, slikaTexture);
-        transpShader.use();
-        projection = glm::perspective(glm::radians(programState->camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        view = programState->camera.GetViewMatrix();
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(7.5f, 2.0f, 4.5f));
-        model = glm::rotate(model,glm::radians(90.0f),glm::vec3(0.0,1.0,0.0));
-        model = glm::scale(model,glm::vec3(1.5f));
-
-        transpShader.setMat4("model", model);
-        transpShader.setMat4("projection", projection);
-        transpShader.setMat4("view", view);
-        glBindVertexArray(slikaVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // drawing skybox as last
-        glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
-        skyboxShader.use();
-        view = glm::mat4(glm::mat3(programState->camera.GetViewMatrix())); // remove translation from the view matrix
-        skyboxShader.setMat4("view", view);
-        skyboxShader.setMat4("projection", projection);
-
-        // skybox cube
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        glDepthFunc(GL_LESS); // set depth function back to default
-
-        if (programState->ImGuiEnabled)
-            DrawImGui(programState);
-
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        glfwSwapBuffers(window);
+        {
+            ProfileZone zone("swap");
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
+        Profiler::Get().EndFrame();
+
+        if (firstFrame) {
+            firstFrame = false;
+            std::cout << "LOADING:: first frame after " << (glfwGetTime() - loadingStart) * 1000.0 << " ms" << std::endl;
+            Trace::Get().Record("startup", startupBegin, Trace::Get().Now());
+        }
     }
 
+    Trace::Get().Write(TRACE_FILE);
     programState->SaveToFile("resources/program_state.txt");
     delete programState;
     ImGui_ImplOpenGL3_Shutdown();
@@ -520,9 +215,7 @@ int main() {
     ImGui::DestroyContext();
     // glfw: terminate, clearing all previously allocated GLFW resources.
 
-    glDeleteVertexArrays(1, &slikaVAO);
-    glDeleteBuffers(1, &slikaVBO);
-    glDeleteBuffers(1, &slikaEBO);
+    scene.Delete();
 
     glfwTerminate();
     return 0;
@@ -583,7 +276,7 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
     programState->camera.ProcessMouseScroll(yoffset);
 }
 
-void DrawImGui(ProgramState *programState) {
+void DrawImGui(ProgramState *programState, const Scene &scene) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -631,6 +324,42 @@ void DrawImGui(ProgramState *programState) {
         ImGui::End();
     }
 
+    {
+        const GLStateCounters &glCalls = GLState::Get().LastFrame();
+        const Profiler &profiler = Profiler::Get();
+        ImGui::Begin("Renderer");
+        const float *frameTimes = profiler.FrameMilliseconds();
+        const float *gpuTimes = profiler.GpuMilliseconds();
+        ImGui::PlotLines("frame ms", frameTimes, PROFILER_HISTORY, 0, nullptr, 0.0f, 33.3f, ImVec2(0, 60));
+        ImGui::PlotLines("gpu ms", gpuTimes, PROFILER_HISTORY, 0, nullptr, 0.0f, 33.3f, ImVec2(0, 60));
+        ImGui::Text("frame: %.2f ms, gpu: %.2f ms", frameTimes[PROFILER_HISTORY - 1], gpuTimes[PROFILER_HISTORY - 1]);
+
+        ImGui::Columns(3);
+        ImGui::Text("zone"); ImGui::NextColumn();
+        ImGui::Text("cpu ms"); ImGui::NextColumn();
+        ImGui::Text("gpu ms"); ImGui::NextColumn();
+        for (const ProfilerZoneStats &zone : profiler.Zones()) {
+            ImGui::Text("%s", zone.name); ImGui::NextColumn();
+            ImGui::Text("%.3f", zone.cpuMilliseconds); ImGui::NextColumn();
+            ImGui::Text("%.3f", zone.gpuMilliseconds); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+
+        ImGui::Text("Draws: %zu in %zu calls, triangles: %zu", scene.DrawCount(), scene.CallCount(), scene.TriangleCount());
+        ImGui::Text("GL state calls: %u issued, %u elided", glCalls.issued, glCalls.elided);
+        ImGui::Text("Frustum culling: %u visible, %u culled", scene.Culling().visible, scene.Culling().culled);
+        GeometryArenaStats geometry = GeometryArena::Get().Stats();
+        ImGui::Text("Geometry arena: %u meshes in %u pages, %zu/%zu KB used, %zu free blocks (largest %zu KB)",
+                    geometry.meshes, geometry.pages, geometry.usedBytes / 1024, geometry.capacityBytes / 1024,
+                    geometry.freeBlocks, geometry.largestFreeBytes / 1024);
+        if (ImGui::Button("Defragment geometry"))
+            GeometryArena::Get().Defragment();
+        // failed shader hot reloads; those programs keep drawing with what they had until the file is fixed
+        for (const std::string &error : scene.ShaderErrors())
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error.c_str());
+        ImGui::End();
+    }
+
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
@@ -644,28 +373,31 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
 
-    if(key == GLFW_KEY_SPACE && action == GLFW_PRESS && programState->gameStart) {
-        double xpos = programState->camera.Front.x;
-        double ypos = programState->camera.Front.y;
-        double zpos = programState->camera.Front.z;
+    Scene *scene = (Scene *) glfwGetWindowUserPointer(window);
+    if(key == GLFW_KEY_SPACE && action == GLFW_PRESS && programState->gameStart && scene) {
+        // whatever the camera looks at moves aside, everything moved before goes back
+        int picked = scene->Pick(programState->camera);
 
         // kaktus
-        if ((xpos - 0.93) * (xpos - 0.93) + (ypos + 0.33) * (ypos + 0.33) + (zpos + 0.13) * (zpos + 0.13) < 0.1 && movingObject.kaktus == -1)
+        if (picked == OBJECT_KAKTUS && movingObject.kaktus == -1)
             movingObject.kaktus = 1;
         else if (movingObject.kaktus == 1)
             movingObject.kaktus = -1;
         // lazybag
-        if ((xpos + 0.06) * (xpos + 0.06) + (ypos + 0.21) * (ypos + 0.21) + (zpos - 0.97) * (zpos - 0.97) < 0.1 && movingObject.lazybag == -1)
+        if (picked == OBJECT_LAZYBAG && movingObject.lazybag == -1)
             movingObject.lazybag = 1;
         else if (movingObject.lazybag == 1)
             movingObject.lazybag = -1;
         // laptop
-        if ((xpos - 0.88) * (xpos - 0.88) + (ypos + 0.20) * (ypos + 0.20) + (zpos - 0.41) * (zpos - 0.41) < 0.1 && movingObject.laptop == -1)
+        if (picked == OBJECT_LAPTOP && movingObject.laptop == -1)
             movingObject.laptop = 1;
         else if (movingObject.laptop == 1)
             movingObject.laptop = -1;
     }
 
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+        Trace::Get().Write(TRACE_FILE);
+
     if(key == GLFW_KEY_ENTER && action == GLFW_PRESS){
         if(movingObject.kaktus == 1){
             programState->diamondColected = true;
@@ -680,73 +412,3 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     }
 }
 
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
-    {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return textureID;
-}
-
-
-unsigned int loadTexture(char const * path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT); // for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
-
-